@@ -2,6 +2,31 @@
 #include <vector>
 #include <string>
 #include <complex>
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "threadpool.h"
+
+#if defined(__has_include)
+#if __has_include("biginteger_tuning.h")
+#include "biginteger_tuning.h"
+#endif
+#endif
+
+#ifndef BIGINTEGER_KARATSUBA_LIMBS
+#define BIGINTEGER_KARATSUBA_LIMBS 40
+#endif
+#ifndef BIGINTEGER_TOOM3_LIMBS
+#define BIGINTEGER_TOOM3_LIMBS 1000
+#endif
+#ifndef BIGINTEGER_FFT_LIMBS
+#define BIGINTEGER_FFT_LIMBS 6000
+#endif
+#ifndef BIGINTEGER_PARALLEL_LIMBS
+#define BIGINTEGER_PARALLEL_LIMBS 500
+#endif
 
 namespace fft {
     const long double PI = acosl(-1);
@@ -20,12 +45,12 @@ namespace fft {
     Polynom toPolynom(const CompPolynom& p) {
         Polynom x(p.size());
         for (size_t i = 0; i < p.size(); ++i) {
-            x[i] = ((int)p[i].real() + 0.5);
+            x[i] = llround(p[i].real());
         }
         return x;
     }
 
-    comp getKCompRoot(size_t n, size_t k = 1) {
+    comp getKCompRoot(size_t n, int k = 1) {
         double angle = (2 * PI * k) / n;
         return comp(cos(angle), sin(angle));
     }
@@ -43,9 +68,10 @@ namespace fft {
         }
         a = fft(a, w * w);
         b = fft(b, w * w);
-        for (size_t i = 0; i < s; ++i) {
-            ans[i] = a[i] + w * b[i];
-            ans[i + s] = a[i] - w * b[i];
+        comp c = 1;
+        for (size_t i = 0; i < s; ++i, c *= w) {
+            ans[i] = a[i] + c * b[i];
+            ans[i + s] = a[i] - c * b[i];
         }
         return ans;
     }
@@ -55,7 +81,11 @@ namespace fft {
     }
 
     CompPolynom fftBack(const CompPolynom& p) {
-        return fft(p, getKCompRoot(p.size(), -1));
+        CompPolynom x = fft(p, getKCompRoot(p.size(), -1));
+        for (size_t i = 0; i < x.size(); ++i) {
+            x[i] /= p.size();
+        }
+        return x;
     } 
 
     Polynom mult(Polynom a, Polynom b) {
@@ -70,31 +100,341 @@ namespace fft {
         CompPolynom cb = fft(toCompPolynom(b));
         CompPolynom ans(n);
         for (size_t i = 0; i < n; ++i) {
-            ans[i] = ca[i] + cb[i];
+            ans[i] = ca[i] * cb[i];
         }
         return toPolynom(fftBack(ans));
     } 
+
+    using Digits = std::vector<uint32_t>;
+
+    const size_t NTT_MAX_SIZE = 1 << 23;
+
+    template<uint32_t N>
+    uint32_t powMod(uint64_t x, uint64_t pow) {
+        uint64_t res = 1;
+        for (x %= N; pow > 0; pow >>= 1) {
+            if (pow & 1) {
+                res = res * x % N;
+            }
+            x = x * x % N;
+        }
+        return static_cast<uint32_t>(res);
+    }
+
+    template<uint32_t N, uint32_t G>
+    void ntt(Digits& p, bool back) {
+        size_t n = p.size();
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(p[i], p[j]);
+            }
+        }
+        Digits roots(n / 2 + 1);
+        for (size_t len = 1; len < n; len <<= 1) {
+            uint64_t w = powMod<N>(G, (N - 1) / (2 * len));
+            if (back) {
+                w = powMod<N>(w, N - 2);
+            }
+            roots[0] = 1;
+            for (size_t j = 1; j < len; ++j) {
+                roots[j] = static_cast<uint32_t>(roots[j - 1] * w % N);
+            }
+            for (size_t i = 0; i < n; i += 2 * len) {
+                for (size_t j = 0; j < len; ++j) {
+                    uint32_t u = p[i + j];
+                    uint32_t v = static_cast<uint32_t>(static_cast<uint64_t>(p[i + j + len]) * roots[j] % N);
+                    p[i + j] = u + v >= N ? u + v - N : u + v;
+                    p[i + j + len] = u >= v ? u - v : u + N - v;
+                }
+            }
+        }
+        if (back) {
+            uint64_t inv = powMod<N>(n, N - 2);
+            for (size_t i = 0; i < n; ++i) {
+                p[i] = static_cast<uint32_t>(p[i] * inv % N);
+            }
+        }
+    }
+
+    template<uint32_t N, uint32_t G>
+    Digits convolution(const Digits& a, const Digits& b, size_t n, ThreadPool* pool = nullptr) {
+        Digits fa(n, 0);
+        Digits fb(n, 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            fa[i] = a[i] % N;
+        }
+        for (size_t i = 0; i < b.size(); ++i) {
+            fb[i] = b[i] % N;
+        }
+        runAll(pool, {
+            [&] { ntt<N, G>(fa, false); },
+            [&] { ntt<N, G>(fb, false); }
+        });
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = static_cast<uint32_t>(static_cast<uint64_t>(fa[i]) * fb[i] % N);
+        }
+        ntt<N, G>(fa, true);
+        return fa;
+    }
+
+    bool fitsNtt(size_t aSize, size_t bSize) {
+        return aSize + bSize <= NTT_MAX_SIZE;
+    }
+
+    Digits multDigits(const Digits& a, const Digits& b, ThreadPool* pool = nullptr) {
+        const uint32_t M1 = 998244353;
+        const uint32_t M2 = 167772161;
+        const uint32_t M3 = 469762049;
+        size_t n = 1;
+        while (n < a.size() + b.size()) {
+            n *= 2;
+        }
+        Digits r1;
+        Digits r2;
+        Digits r3;
+        runAll(pool, {
+            [&] { r1 = convolution<M1, 3>(a, b, n, pool); },
+            [&] { r2 = convolution<M2, 3>(a, b, n, pool); },
+            [&] { r3 = convolution<M3, 3>(a, b, n, pool); }
+        });
+        const uint64_t inv12 = powMod<M2>(M1, M2 - 2);
+        const uint64_t inv123 = powMod<M3>(static_cast<uint64_t>(M1) * M2 % M3, M3 - 2);
+        const uint64_t m12 = static_cast<uint64_t>(M1) * M2;
+        Digits ans(a.size() + b.size(), 0);
+        unsigned __int128 carry = 0;
+        for (size_t i = 0; i < ans.size(); ++i) {
+            uint64_t t1 = r1[i];
+            uint64_t t2 = (r2[i] + M2 - t1 % M2) % M2 * inv12 % M2;
+            uint64_t x12 = t1 + t2 * M1;
+            uint64_t t3 = (r3[i] + M3 - x12 % M3) % M3 * inv123 % M3;
+            carry += x12 + static_cast<unsigned __int128>(t3) * m12;
+            ans[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return ans;
+    }
 }
 
+class LimbVec {
+public:
+    using value_type = uint64_t;
+    using iterator = uint64_t*;
+    using const_iterator = const uint64_t*;
+
+private:
+    static const size_t INLINE_SIZE = 2;
+    uint64_t* ptr;
+    size_t len;
+    size_t cap;
+    uint64_t local[INLINE_SIZE];
+
+    bool isInline() const {
+        return ptr == local;
+    }
+
+    void grow(size_t need) {
+        size_t newCap = need > 2 * cap ? need : 2 * cap;
+        uint64_t* p = new uint64_t[newCap];
+        std::copy(ptr, ptr + len, p);
+        if (!isInline()) {
+            delete[] ptr;
+        }
+        ptr = p;
+        cap = newCap;
+    }
+
+    void release() {
+        if (!isInline()) {
+            delete[] ptr;
+        }
+        ptr = local;
+        cap = INLINE_SIZE;
+        len = 0;
+    }
+
+    void steal(LimbVec& x) {
+        if (x.isInline()) {
+            std::copy(x.local, x.local + x.len, local);
+        } else {
+            ptr = x.ptr;
+            cap = x.cap;
+            x.ptr = x.local;
+            x.cap = INLINE_SIZE;
+        }
+        len = x.len;
+        x.len = 0;
+    }
+
+public:
+    LimbVec() : ptr(local), len(0), cap(INLINE_SIZE), local() {}
+
+    explicit LimbVec(size_t n, uint64_t value = 0) : LimbVec() {
+        assign(n, value);
+    }
+
+    LimbVec(const LimbVec& x) : LimbVec() {
+        assign(x.begin(), x.end());
+    }
+
+    LimbVec(LimbVec&& x) noexcept : LimbVec() {
+        steal(x);
+    }
+
+    ~LimbVec() {
+        release();
+    }
+
+    LimbVec& operator=(const LimbVec& x) {
+        if (this != &x) {
+            assign(x.begin(), x.end());
+        }
+        return *this;
+    }
+
+    LimbVec& operator=(LimbVec&& x) noexcept {
+        if (this != &x) {
+            release();
+            steal(x);
+        }
+        return *this;
+    }
+
+    void swap(LimbVec& x) {
+        LimbVec tmp(std::move(x));
+        x = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    size_t size() const {
+        return len;
+    }
+
+    bool empty() const {
+        return len == 0;
+    }
+
+    uint64_t* data() {
+        return ptr;
+    }
+
+    const uint64_t* data() const {
+        return ptr;
+    }
+
+    iterator begin() {
+        return ptr;
+    }
+
+    iterator end() {
+        return ptr + len;
+    }
+
+    const_iterator begin() const {
+        return ptr;
+    }
+
+    const_iterator end() const {
+        return ptr + len;
+    }
+
+    uint64_t& operator[](size_t i) {
+        return ptr[i];
+    }
+
+    const uint64_t& operator[](size_t i) const {
+        return ptr[i];
+    }
+
+    uint64_t& back() {
+        return ptr[len - 1];
+    }
+
+    const uint64_t& back() const {
+        return ptr[len - 1];
+    }
+
+    void reserve(size_t n) {
+        if (n > cap) {
+            grow(n);
+        }
+    }
+
+    void resize(size_t n, uint64_t value = 0) {
+        reserve(n);
+        if (n > len) {
+            std::fill(ptr + len, ptr + n, value);
+        }
+        len = n;
+    }
+
+    void assign(size_t n, uint64_t value) {
+        len = 0;
+        resize(n, value);
+    }
+
+    void assign(const uint64_t* first, const uint64_t* last) {
+        size_t n = last - first;
+        if (n > cap) {
+            LimbVec x;
+            x.grow(n);
+            std::copy(first, last, x.ptr);
+            x.len = n;
+            *this = std::move(x);
+            return;
+        }
+        std::copy(first, last, ptr);
+        len = n;
+    }
+
+    void push_back(uint64_t value) {
+        if (len == cap) {
+            grow(len + 1);
+        }
+        ptr[len++] = value;
+    }
+
+    void pop_back() {
+        --len;
+    }
+
+    void clear() {
+        len = 0;
+    }
+
+    iterator insert(iterator pos, size_t count, uint64_t value) {
+        size_t at = pos - ptr;
+        reserve(len + count);
+        std::copy_backward(ptr + at, ptr + len, ptr + len + count);
+        std::fill(ptr + at, ptr + at + count, value);
+        len += count;
+        return ptr + at;
+    }
+
+    iterator erase(iterator first, iterator last) {
+        std::copy(last, ptr + len, first);
+        len -= last - first;
+        return first;
+    }
+};
+
 class BigInteger {
 private:
-    using elemVec = std::vector<int64_t>;
+    using limb = uint64_t;
+    using doubleLimb = unsigned __int128;
+    using elemVec = LimbVec;
 
-    static const int64_t MEMBER_SIZE = 1000;
-    static const int64_t MEMBER_POW = 3;
+    static const int LIMB_BITS = 64;
+    static const limb DEC_MEMBER_SIZE = 10000000000000000000ull;
+    static const size_t DEC_MEMBER_POW = 19;
     static const int64_t BASIS = 10;
     bool isPositive = true;
     elemVec a;
     BigInteger& norm() {
-        for (size_t i = 0; i < a.size(); ++i) {
-            if (a[i] >= MEMBER_SIZE) {
-                if (i + 1 == a.size()) {
-                    a.push_back(0);
-                }
-                a[i + 1] += a[i] / MEMBER_SIZE;
-                a[i] %= MEMBER_SIZE;
-            }
-        }
         for (; a.size() > 0 && a.back() == 0;) {
             a.pop_back();
         }
@@ -104,17 +444,141 @@ private:
         return *this;
     }
 
+    static int compare(const elemVec& x, const elemVec& y) {
+        if (x.size() != y.size()) {
+            return x.size() < y.size() ? -1 : 1;
+        }
+        for (size_t i = x.size(); i > 0; --i) {
+            if (x[i - 1] != y[i - 1]) {
+                return x[i - 1] < y[i - 1] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static void addTo(elemVec& x, const elemVec& y, size_t offset = 0) {
+        if (y.size() == 0) {
+            return;
+        }
+        if (x.size() < y.size() + offset) {
+            x.resize(y.size() + offset, 0);
+        }
+        limb carry = 0;
+        size_t ySize = y.size();
+        for (size_t i = offset; i < x.size() && (carry != 0 || i - offset < ySize); ++i) {
+            doubleLimb t = static_cast<doubleLimb>(x[i]) + (i - offset < ySize ? y[i - offset] : 0) + carry;
+            x[i] = static_cast<limb>(t);
+            carry = static_cast<limb>(t >> LIMB_BITS);
+        }
+        if (carry != 0) {
+            x.push_back(carry);
+        }
+    }
+
+    static void subFrom(elemVec& x, const elemVec& y) {
+        limb borrow = 0;
+        size_t ySize = y.size();
+        for (size_t i = 0; i < x.size() && (borrow != 0 || i < ySize); ++i) {
+            limb yi = i < ySize ? y[i] : 0;
+            limb t = x[i] - yi - borrow;
+            borrow = (x[i] < yi || (x[i] == yi && borrow != 0)) ? 1 : 0;
+            x[i] = t;
+        }
+    }
+
+    static void addMulSmall(elemVec& x, const elemVec& y, limb m) {
+        size_t ySize = y.size();
+        if (x.size() < ySize + 1) {
+            x.resize(ySize + 1, 0);
+        }
+        limb carry = 0;
+        size_t i = 0;
+        for (; i < ySize; ++i) {
+            doubleLimb t = static_cast<doubleLimb>(y[i]) * m + x[i] + carry;
+            x[i] = static_cast<limb>(t);
+            carry = static_cast<limb>(t >> LIMB_BITS);
+        }
+        for (; carry != 0 && i < x.size(); ++i) {
+            doubleLimb t = static_cast<doubleLimb>(x[i]) + carry;
+            x[i] = static_cast<limb>(t);
+            carry = static_cast<limb>(t >> LIMB_BITS);
+        }
+        if (carry != 0) {
+            x.push_back(carry);
+        }
+    }
+
+    static void multSmall(elemVec& x, limb m, limb add = 0) {
+        limb carry = add;
+        for (size_t i = 0; i < x.size(); ++i) {
+            doubleLimb t = static_cast<doubleLimb>(x[i]) * m + carry;
+            x[i] = static_cast<limb>(t);
+            carry = static_cast<limb>(t >> LIMB_BITS);
+        }
+        if (carry != 0) {
+            x.push_back(carry);
+        }
+    }
+
+    static limb divSmall(elemVec& x, limb d) {
+        doubleLimb rest = 0;
+        for (size_t i = x.size(); i > 0; --i) {
+            doubleLimb t = (rest << LIMB_BITS) | x[i - 1];
+            x[i - 1] = static_cast<limb>(t / d);
+            rest = t % d;
+        }
+        for (; x.size() > 0 && x.back() == 0;) {
+            x.pop_back();
+        }
+        return static_cast<limb>(rest);
+    }
+
+    static void divMod(const elemVec& u, const elemVec& v, elemVec& q, elemVec& r);
+    static void divModSchool(const elemVec& u, const elemVec& v, elemVec& q, elemVec& r);
+
+    static const size_t DIV_SCHOOL_LIMBS = 40;
+    static const size_t DIV_NEWTON_LIMBS = 100000;
+
+    static void shiftBitsLeft(elemVec& x, int s);
+    static void shiftBitsRight(elemVec& x, int s);
+    static BigInteger limbPower(size_t n);
+    BigInteger lowLimbs(size_t n) const;
+    BigInteger limbSlice(size_t from, size_t n) const;
+    static void divExact(BigInteger& x, limb d);
+    static BigInteger unbalancedMult(const BigInteger& x, const BigInteger& y);
+    static int compareSpans(const limb* x, size_t nx, const limb* y, size_t ny);
+    static limb addSpans(limb* r, const limb* x, size_t nx, const limb* y, size_t ny);
+    static limb subSpans(limb* r, const limb* x, size_t nx, const limb* y, size_t ny);
+    static void multSpans(limb* r, const limb* x, size_t nx, const limb* y, size_t ny);
+    static size_t karatsubaScratch(size_t n);
+    static bool karatsubaDiffs(limb* dx, limb* dy, const limb* x, const limb* y, size_t n);
+    static void karatsubaCombine(limb* r, limb* zm, size_t n, bool sameSign);
+    static void karatsubaSpans(limb* r, const limb* x, const limb* y, size_t n, limb* scratch);
+    static void karatsubaParallel(limb* r, const limb* x, const limb* y, size_t n, size_t tasks);
+    static size_t multScratch(size_t nx, size_t ny);
+    static void multSpansFast(limb* r, const limb* x, size_t nx, const limb* y, size_t ny, limb* scratch);
+    static BigInteger toom3Mult(const BigInteger& x, const BigInteger& y);
+    static BigInteger div2n1n(const BigInteger& a, const BigInteger& b, size_t n, BigInteger& r);
+    static BigInteger div3n2n(const BigInteger& a12, const BigInteger& a3, const BigInteger& b,
+        const BigInteger& b1, const BigInteger& b2, size_t n, BigInteger& r);
+    static BigInteger reciprocal(const BigInteger& v);
+    static BigInteger divNewton(const BigInteger& a, const BigInteger& b, const BigInteger& inv, BigInteger& r);
+
+    static const size_t DEC_SPLIT_LIMBS = 32;
+
+    static const BigInteger& decPower(size_t k);
+    static BigInteger fromDecimal(const char* s, size_t len);
+    template<typename Sink>
+    static void writeDecimalPart(const elemVec& x, size_t pad, Sink& sink);
+
     BigInteger& mult(int x) {
         if (x < 0) {
             isPositive = !isPositive;
         }
-        x = abs(x);
         if (x == 0) {
             clear();
         } else {
-            for (size_t i = 0; i < a.size(); ++i) {
-                a[i] *= x;
-            }
+            multSmall(a, static_cast<limb>(std::abs(static_cast<int64_t>(x))));
             norm();
         }
         return *this;
@@ -127,12 +591,41 @@ private:
     }
 
     std::pair<BigInteger, BigInteger> div(const BigInteger& x) const;
+    BigInteger& addSigned(const BigInteger& x, bool xPositive);
+    std::vector<bool> toBits() const;
+    BigInteger& addProduct(const BigInteger& y, const BigInteger& z, bool negate);
 
 public:
     friend bool operator==(const BigInteger& x, const BigInteger& y);
     friend bool operator<(const BigInteger& x, const BigInteger& y);
     friend BigInteger mult(const BigInteger& x, const BigInteger& y);
     friend BigInteger fastMult(const BigInteger& x, const BigInteger& y);
+    friend BigInteger& addmul(BigInteger& x, const BigInteger& y, const BigInteger& z);
+    friend BigInteger& submul(BigInteger& x, const BigInteger& y, const BigInteger& z);
+    friend class MontgomeryContext;
+    friend BigInteger powMod(const BigInteger& base, const BigInteger& exp, const BigInteger& m);
+
+    struct MultThresholds {
+        size_t karatsuba;
+        size_t toom3;
+        size_t fft;
+        size_t parallel;
+    };
+
+    static MultThresholds& multThresholds() {
+        static MultThresholds limits = {BIGINTEGER_KARATSUBA_LIMBS, BIGINTEGER_TOOM3_LIMBS, BIGINTEGER_FFT_LIMBS,
+            BIGINTEGER_PARALLEL_LIMBS};
+        return limits;
+    }
+
+    static fft::ThreadPool*& threadPool() {
+        static fft::ThreadPool* pool = nullptr;
+        return pool;
+    }
+
+    static void setThreadPool(fft::ThreadPool* pool) {
+        threadPool() = pool;
+    }
 
     BigInteger() {}
 
@@ -141,61 +634,74 @@ public:
         a = x.a;
     }
 
+    BigInteger(BigInteger&& x) noexcept : isPositive(x.isPositive), a(std::move(x.a)) {
+        x.isPositive = true;
+    }
+
     BigInteger& fftMult(const BigInteger& x) {
-        fft::Polynom p = fft::mult(this->a, x.a);
-        a = p;
+        if (!fft::fitsNtt(2 * a.size(), 2 * x.a.size())) {
+            *this = fastMult(*this, x);
+            return *this;
+        }
+        fft::Digits p(2 * a.size());
+        fft::Digits q(2 * x.a.size());
+        for (size_t i = 0; i < p.size(); ++i) {
+            p[i] = static_cast<uint32_t>(a[i / 2] >> (32 * (i % 2)));
+        }
+        for (size_t i = 0; i < q.size(); ++i) {
+            q[i] = static_cast<uint32_t>(x.a[i / 2] >> (32 * (i % 2)));
+        }
+        fft::ThreadPool* pool = std::min(a.size(), x.a.size()) >= multThresholds().parallel ? threadPool() : nullptr;
+        fft::Digits c = fft::multDigits(p, q, pool);
+        isPositive = (isPositive == x.isPositive);
+        a.assign(c.size() / 2, 0);
+        for (size_t i = 0; i < c.size(); ++i) {
+            a[i / 2] |= static_cast<limb>(c[i]) << (32 * (i % 2));
+        }
         norm();
         return *this;
     }
     
     BigInteger(int x) : isPositive(x >= 0) {
-        x = abs(x);
         if (x != 0) {
-            a.push_back(x);
-            norm();
+            a.push_back(static_cast<limb>(std::abs(static_cast<int64_t>(x))));
         }
     }
 
-    BigInteger(int x, size_t pow) : isPositive(x >= 0 || pow % 2 == 0) {
-        a.push_back(1);
-        x = abs(x);
-        if (x > 1) {
-            for (size_t i = 0; i < pow; i++) {
-                mult(x);
+    BigInteger(int x, size_t pow) : BigInteger(1) {
+        if (x == BASIS) {
+            *this = powerOfTen(pow);
+            return;
+        }
+        BigInteger base(x);
+        for (; pow > 0; pow >>= 1) {
+            if (pow & 1) {
+                *this *= base;
             }
-        } else {
-            if (x == 0 && pow != 0) {
-                a.back() = 0;
+            if (pow > 1) {
+                base *= base;
             }
         }
     }
 
     BigInteger(const std::string& s) {
-        if (s.size() == 0) {
-            return;
+        size_t start = (s.size() > 0 && s[0] == '-') ? 1 : 0;
+        *this = fromDecimal(s.data() + start, s.size() - start);
+        setPositivity(start == 0);
+    }
+
+    static BigInteger powerOfTen(size_t pow) {
+        BigInteger result(1);
+        for (size_t i = 0; i < pow % DEC_MEMBER_POW; ++i) {
+            multSmall(result.a, BASIS);
         }
-        int64_t powNum = 1;
-        size_t member = 0;
-        for (size_t i = s.size() - 1;; --i, powNum *= 10) {
-            if (i == 0 && s[i] == '-') {
-                isPositive = false;
-                break;
-            }
-            if (powNum >= MEMBER_SIZE) {
-                powNum /= MEMBER_SIZE;
-                member++;
-            }
-            if (a.size() <= member) {
-                a.push_back(0);
-            }
-            if (s[i] != '0') {
-                a[member] += powNum * (s[i] - '0');
-            }
-            if (i == 0) {
-                break;
+        pow /= DEC_MEMBER_POW;
+        for (size_t k = 0; pow > 0; ++k, pow >>= 1) {
+            if (pow & 1) {
+                result *= decPower(k);
             }
         }
-        norm();
+        return result;
     }
 
     explicit operator bool() const {
@@ -204,17 +710,10 @@ public:
 
     explicit operator double() const {
         double d = 0;
-        if (a.size() > 0) {
-            for (size_t i = a.size() - 1;; i--) {
-                d *= MEMBER_SIZE;
-                d += a[i];
-                if (i == 0) {
-                    break;
-                }
-            }
-            d *= (isPositive?1:-1);
+        for (size_t i = a.size(); i > 0; --i) {
+            d = d * 18446744073709551616.0 + static_cast<double>(a[i - 1]);
         }
-        return d;
+        return d * (isPositive ? 1 : -1);
     }
 
     BigInteger& setPositive() {
@@ -237,14 +736,7 @@ public:
         if (a.size() == 0 || x == 0) {
             return *this;
         }
-        a.resize(a.size() + x, 0);
-        for (size_t i = a.size() - x - 1;; --i) {
-            a[i + x] = a[i];
-            a[i] = 0;
-            if (i == 0) {
-                break;
-            }
-        }
+        a.insert(a.begin(), x, 0);
         return *this;
     }
 
@@ -256,36 +748,43 @@ public:
             clear();
             return *this;
         }
-        for (size_t i = x; i < a.size(); ++i) {
-            a[i - x] = a[i];
-        }
-        a.resize(a.size() - x);
+        a.erase(a.begin(), a.begin() + x);
         return *this;
     }
 
-    BigInteger operator<<(uint x) {
+    BigInteger operator<<(uint x) const {
         BigInteger cp = *this;
         cp <<= x;
         return cp;
     }
 
-    BigInteger operator>>(uint x) {
+    BigInteger operator>>(uint x) const {
         BigInteger cp = *this;
         cp >>= x;
         return cp;
     }
 
     BigInteger& operator=(const BigInteger& x) {
-        BigInteger y(x);
-        swap(y);
+        isPositive = x.isPositive;
+        a = x.a;
+        return *this;
+    }
+
+    BigInteger& operator=(BigInteger&& x) noexcept {
+        if (this != &x) {
+            isPositive = x.isPositive;
+            a = std::move(x.a);
+            x.isPositive = true;
+        }
         return *this;
     }
 
-    BigInteger& operator+=(const BigInteger& x);
+    BigInteger& operator+=(const BigInteger& x) {
+        return addSigned(x, x.isPositive);
+    }
     
     BigInteger& operator-=(const BigInteger& x) {
-        operator+=(-x);
-        return *this;
+        return addSigned(x, !x.isPositive);
     }
     
     BigInteger& operator*=(const BigInteger& x) {
@@ -339,32 +838,24 @@ public:
         a.clear();
     }
     
-    std::string toString() const {
+    template<typename Sink>
+    void writeDecimal(Sink& sink) const {
         if (a.size() == 0) {
-            return "0";
+            sink("0", 1);
+            return;
         }
-        std::string ans;
-        int64_t x;
-        int64_t pos;
-        bool numStarted = false;
         if (!isPositive) {
-            ans += '-';
-        }
-        for (size_t i = a.size() - 1;; --i) {
-            pos = MEMBER_SIZE;
-            for (size_t j = MEMBER_POW; j > 0; --j) {
-                pos /= BASIS;
-                x = (a[i] / pos) % BASIS;
-                if (i + 1 == a.size() && x == 0 && !numStarted) {
-                    continue;
-                }
-                numStarted = true;
-                ans += (x + '0');
-            }
-            if (i == 0) {
-                break;
-            }
+            sink("-", 1);
         }
+        writeDecimalPart(a, 0, sink);
+    }
+
+    std::string toString() const {
+        std::string ans;
+        auto sink = [&ans](const char* s, size_t n) {
+            ans.append(s, n);
+        };
+        writeDecimal(sink);
         return ans;
     }
 
@@ -386,16 +877,45 @@ BigInteger operator+(const BigInteger& x, const BigInteger& y) {
     return cp;
 }
 
+BigInteger operator+(BigInteger&& x, const BigInteger& y) {
+    x += y;
+    return std::move(x);
+}
+
+BigInteger operator+(const BigInteger& x, BigInteger&& y) {
+    y += x;
+    return std::move(y);
+}
+
+BigInteger operator+(BigInteger&& x, BigInteger&& y) {
+    x += y;
+    return std::move(x);
+}
+
 BigInteger operator-(const BigInteger& x, const BigInteger& y) {
     BigInteger cp = x;
     cp -= y;
     return cp;
 }
 
+BigInteger operator-(BigInteger&& x, const BigInteger& y) {
+    x -= y;
+    return std::move(x);
+}
+
+BigInteger operator-(const BigInteger& x, BigInteger&& y) {
+    y -= x;
+    y.setPositivity(!y.getPositivity());
+    return std::move(y);
+}
+
+BigInteger operator-(BigInteger&& x, BigInteger&& y) {
+    x -= y;
+    return std::move(x);
+}
+
 BigInteger operator*(const BigInteger& x, const BigInteger& y) {
-    BigInteger cp = x;
-    cp *= y;
-    return cp;
+    return fastMult(x, y);
 }
 
 BigInteger operator/(const BigInteger& x, const BigInteger& y) {
@@ -404,12 +924,22 @@ BigInteger operator/(const BigInteger& x, const BigInteger& y) {
     return cp;
 }
 
+BigInteger operator/(BigInteger&& x, const BigInteger& y) {
+    x /= y;
+    return std::move(x);
+}
+
 BigInteger operator%(const BigInteger& x, const BigInteger& y) {
     BigInteger cp = x;
     cp %= y;
     return cp;
 }
 
+BigInteger operator%(BigInteger&& x, const BigInteger& y) {
+    x %= y;
+    return std::move(x);
+}
+
 bool operator==(const BigInteger& x, const BigInteger& y) {
     if (x.a.size() != y.a.size() || x.isPositive != y.isPositive) {
         return false;
@@ -426,21 +956,8 @@ bool operator<(const BigInteger& x, const BigInteger& y) {
     if (x.isPositive != y.isPositive) {
         return y.isPositive;
     }
-    if (x.a.size() != y.a.size()) {
-        return x.isPositive == (x.a.size() < y.a.size());
-    }
-    if (x.a.size() == 0) {
-        return false;
-    }
-    for (size_t i = x.a.size() - 1;; --i) {
-        if (x.a[i] != y.a[i]) {
-            return x.isPositive == (x.a[i] < y.a[i]);  
-        }
-        if (i == 0) {
-            break;
-        }
-    }
-    return false;
+    int c = BigInteger::compare(x.a, y.a);
+    return x.isPositive ? c < 0 : c > 0;
 }
 
 bool operator!=(const BigInteger& x, const BigInteger& y) {
@@ -459,31 +976,249 @@ bool operator<=(const BigInteger& x, const BigInteger& y) {
     return !(x > y);
 }
 
-std::pair<BigInteger, BigInteger> BigInteger::div(const BigInteger& x) const {
-    BigInteger divRes; // /
-    BigInteger num = this->getsetPositiveed(); // %
-    BigInteger xsetPositiveed;
-    int divBuf;
-    size_t divPos;
-    if (a.size() > 0 && x.a.size() > 0 && x.a.size() <= a.size()) {
-        xsetPositiveed = x.getsetPositiveed();
-        divRes.a.resize(a.size() - x.a.size() + 1, 0);
-        for (size_t i = a.size() - 1;; --i) {
-            divPos = (i + 1) - x.a.size(); 
-            BigInteger y = (xsetPositiveed << divPos); 
-            divBuf = std::max(static_cast<int>(static_cast<double>(num) / 
-            static_cast<double>(y)), 0);
-            num -= y.multCpy(divBuf);
-            for (; num >= y;) {
-                divBuf += 1;
-                num -= y;
-            }
-            divRes.a[divPos] = divBuf;
-            if (i < x.a.size()) {
+void BigInteger::divModSchool(const elemVec& u, const elemVec& v, elemVec& q, elemVec& r) {
+    if (compare(u, v) < 0) {
+        q.clear();
+        r = u;
+        return;
+    }
+    if (v.size() == 1) {
+        q = u;
+        limb rest = divSmall(q, v[0]);
+        r.assign(rest == 0 ? 0 : 1, rest);
+        return;
+    }
+    size_t n = v.size();
+    size_t m = u.size() - n;
+    int s = __builtin_clzll(v.back());
+    elemVec vn(n);
+    elemVec un(u.size() + 1);
+    for (size_t i = n - 1; i > 0; --i) {
+        vn[i] = (v[i] << s) | (s == 0 ? 0 : v[i - 1] >> (LIMB_BITS - s));
+    }
+    vn[0] = v[0] << s;
+    un[u.size()] = s == 0 ? 0 : u.back() >> (LIMB_BITS - s);
+    for (size_t i = u.size() - 1; i > 0; --i) {
+        un[i] = (u[i] << s) | (s == 0 ? 0 : u[i - 1] >> (LIMB_BITS - s));
+    }
+    un[0] = u[0] << s;
+    q.assign(m + 1, 0);
+    const doubleLimb base = static_cast<doubleLimb>(1) << LIMB_BITS;
+    for (size_t j = m + 1; j > 0; --j) {
+        size_t k = j - 1;
+        doubleLimb top = (static_cast<doubleLimb>(un[k + n]) << LIMB_BITS) | un[k + n - 1];
+        doubleLimb qhat = top / vn[n - 1];
+        doubleLimb rhat = top % vn[n - 1];
+        while (qhat >= base || qhat * vn[n - 2] > ((rhat << LIMB_BITS) | un[k + n - 2])) {
+            --qhat;
+            rhat += vn[n - 1];
+            if (rhat >= base) {
                 break;
             }
         }
+        limb borrow = 0;
+        limb carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            doubleLimb p = qhat * vn[i] + carry;
+            carry = static_cast<limb>(p >> LIMB_BITS);
+            limb low = static_cast<limb>(p);
+            limb t = un[i + k] - low - borrow;
+            borrow = (un[i + k] < low || (un[i + k] == low && borrow != 0)) ? 1 : 0;
+            un[i + k] = t;
+        }
+        limb t = un[k + n] - carry - borrow;
+        bool negative = un[k + n] < carry || (un[k + n] == carry && borrow != 0);
+        un[k + n] = t;
+        if (negative) {
+            --qhat;
+            limb c = 0;
+            for (size_t i = 0; i < n; ++i) {
+                doubleLimb sum = static_cast<doubleLimb>(un[i + k]) + vn[i] + c;
+                un[i + k] = static_cast<limb>(sum);
+                c = static_cast<limb>(sum >> LIMB_BITS);
+            }
+            un[k + n] += c;
+        }
+        q[k] = static_cast<limb>(qhat);
+    }
+    r.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = (un[i] >> s) | (s == 0 ? 0 : un[i + 1] << (LIMB_BITS - s));
+    }
+    for (; q.size() > 0 && q.back() == 0;) {
+        q.pop_back();
+    }
+    for (; r.size() > 0 && r.back() == 0;) {
+        r.pop_back();
+    }
+}
+
+void BigInteger::shiftBitsLeft(elemVec& x, int s) {
+    if (s == 0 || x.size() == 0) {
+        return;
+    }
+    limb top = x.back() >> (LIMB_BITS - s);
+    for (size_t i = x.size() - 1; i > 0; --i) {
+        x[i] = (x[i] << s) | (x[i - 1] >> (LIMB_BITS - s));
+    }
+    x[0] <<= s;
+    if (top != 0) {
+        x.push_back(top);
+    }
+}
+
+void BigInteger::shiftBitsRight(elemVec& x, int s) {
+    if (s == 0 || x.size() == 0) {
+        return;
+    }
+    for (size_t i = 0; i + 1 < x.size(); ++i) {
+        x[i] = (x[i] >> s) | (x[i + 1] << (LIMB_BITS - s));
+    }
+    x.back() >>= s;
+    for (; x.size() > 0 && x.back() == 0;) {
+        x.pop_back();
+    }
+}
+
+BigInteger BigInteger::limbPower(size_t n) {
+    BigInteger x;
+    x.a.assign(n + 1, 0);
+    x.a[n] = 1;
+    return x;
+}
+
+BigInteger BigInteger::lowLimbs(size_t n) const {
+    return limbSlice(0, n);
+}
+
+BigInteger BigInteger::limbSlice(size_t from, size_t n) const {
+    BigInteger x;
+    if (from < a.size()) {
+        x.a.assign(a.begin() + from, a.begin() + std::min(from + n, a.size()));
+    }
+    return x.norm();
+}
+
+BigInteger BigInteger::div2n1n(const BigInteger& a, const BigInteger& b, size_t n, BigInteger& r) {
+    BigInteger q;
+    if (n < DIV_SCHOOL_LIMBS) {
+        divModSchool(a.a, b.a, q.a, r.a);
+        r.setPositive();
+        return q;
+    }
+    if (n % 2 == 1) {
+        q = div2n1n(a << 1, b << 1, n + 1, r);
+        r >>= 1;
+        return q;
+    }
+    size_t half = n / 2;
+    BigInteger b1 = b >> half;
+    BigInteger b2 = b.lowLimbs(half);
+    BigInteger q1 = div3n2n(a >> n, (a >> half).lowLimbs(half), b, b1, b2, half, r);
+    BigInteger r1 = r;
+    BigInteger q2 = div3n2n(r1, a.lowLimbs(half), b, b1, b2, half, r);
+    q = (q1 << half) + q2;
+    return q;
+}
+
+BigInteger BigInteger::div3n2n(const BigInteger& a12, const BigInteger& a3, const BigInteger& b,
+    const BigInteger& b1, const BigInteger& b2, size_t n, BigInteger& r) {
+    BigInteger q;
+    if ((a12 >> n) == b1) {
+        q.a.assign(n, ~static_cast<limb>(0));
+        r = a12 - (b1 << n) + b1;
+    } else {
+        q = div2n1n(a12, b1, n, r);
+    }
+    r <<= n;
+    r += a3;
+    submul(r, q, b2);
+    while (!r.isPositive) {
+        --q;
+        r += b;
+    }
+    return q;
+}
+
+BigInteger BigInteger::reciprocal(const BigInteger& v) {
+    size_t n = v.a.size();
+    BigInteger x;
+    if (n < DIV_SCHOOL_LIMBS) {
+        BigInteger r;
+        divModSchool(limbPower(2 * n).a, v.a, x.a, r.a);
+        return x;
+    }
+    size_t h = (n + 1) / 2;
+    BigInteger xh = reciprocal(v >> (n - h));
+    BigInteger r = limbPower(2 * n) - ((v * xh) << (n - h));
+    BigInteger delta = (xh * (r >> (n - h))) >> (2 * h);
+    x = (xh << (n - h)) + delta;
+    r -= v * delta;
+    while (!r.isPositive) {
+        --x;
+        r += v;
+    }
+    while (r >= v) {
+        ++x;
+        r -= v;
+    }
+    return x;
+}
+
+BigInteger BigInteger::divNewton(const BigInteger& a, const BigInteger& b, const BigInteger& inv, BigInteger& r) {
+    size_t n = b.a.size();
+    BigInteger q = ((a >> (n - 1)) * inv) >> (n + 1);
+    r = a - q * b;
+    while (!r.isPositive) {
+        --q;
+        r += b;
+    }
+    while (r >= b) {
+        ++q;
+        r -= b;
     }
+    return q;
+}
+
+void BigInteger::divMod(const elemVec& u, const elemVec& v, elemVec& q, elemVec& r) {
+    if (v.size() < DIV_SCHOOL_LIMBS || u.size() < v.size() + DIV_SCHOOL_LIMBS) {
+        divModSchool(u, v, q, r);
+        return;
+    }
+    int s = __builtin_clzll(v.back());
+    BigInteger x;
+    BigInteger y;
+    x.a = u;
+    y.a = v;
+    shiftBitsLeft(x.a, s);
+    shiftBitsLeft(y.a, s);
+    size_t n = y.a.size();
+    BigInteger inv;
+    if (n >= DIV_NEWTON_LIMBS) {
+        inv = reciprocal(y);
+    }
+    size_t blocks = (x.a.size() + n - 1) / n;
+    q.assign(blocks * n, 0);
+    BigInteger rest;
+    for (size_t i = blocks; i > 0; --i) {
+        BigInteger cur = (rest << n) + (x >> ((i - 1) * n)).lowLimbs(n);
+        BigInteger digit = n >= DIV_NEWTON_LIMBS ? divNewton(cur, y, inv, rest) : div2n1n(cur, y, n, rest);
+        std::copy(digit.a.begin(), digit.a.end(), q.begin() + (i - 1) * n);
+    }
+    for (; q.size() > 0 && q.back() == 0;) {
+        q.pop_back();
+    }
+    r = rest.a;
+    shiftBitsRight(r, s);
+}
+
+std::pair<BigInteger, BigInteger> BigInteger::div(const BigInteger& x) const {
+    BigInteger divRes; // /
+    BigInteger num; // %
+    if (x.a.size() == 0) {
+        return {divRes, *this};
+    }
+    divMod(a, x.a, divRes.a, num.a);
     num.norm();
     divRes.norm();
     num.setPositivity(isPositive);
@@ -496,19 +1231,8 @@ BigInteger mult(const BigInteger& x, const BigInteger& y) {
     if (x.a.size() == 0 || y.a.size() == 0) {
         return multRes;
     }
-    multRes.a.resize(x.a.size() * y.a.size(), 0);
-    for (size_t i = 0; i < x.a.size(); ++i) {
-        for (size_t j = 0; j < y.a.size(); ++j) {
-            multRes.a[i + j] += x.a[i] * y.a[j];
-            for (size_t k = i + j; multRes.a[k] >= BigInteger::MEMBER_SIZE; ++k) {
-                if (k + 1 == multRes.a.size()) {
-                    multRes.a.push_back(0);
-                }
-                multRes.a[k + 1] += multRes.a[k] / BigInteger::MEMBER_SIZE;
-                multRes.a[k] %= BigInteger::MEMBER_SIZE;
-            }
-        }
-    }
+    multRes.a.resize(x.a.size() + y.a.size(), 0);
+    BigInteger::multSpans(multRes.a.data(), x.a.data(), x.a.size(), y.a.data(), y.a.size());
     multRes.setPositivity(x.isPositive == y.isPositive);
     multRes.norm();
     return multRes;
@@ -522,96 +1246,412 @@ std::istream& operator>>(std::istream& in, BigInteger& x) {
 }
 
 std::ostream& operator<<(std::ostream& out, const BigInteger& x) {
-    out << x.toString();
+    auto sink = [&out](const char* s, size_t n) {
+        out.write(s, n);
+    };
+    x.writeDecimal(sink);
     return out;
 }
 
-BigInteger fastMult(const BigInteger& xIn, const BigInteger& yIn) {
-    const static size_t MIN_FAST_MULT_SIZE = 10;
+void BigInteger::divExact(BigInteger& x, limb d) {
+    divSmall(x.a, d);
+    x.norm();
+}
+
+BigInteger BigInteger::unbalancedMult(const BigInteger& x, const BigInteger& y) {
+    const BigInteger& longer = x.a.size() >= y.a.size() ? x : y;
+    const BigInteger& shorter = x.a.size() >= y.a.size() ? y : x;
+    size_t n = shorter.a.size();
+    BigInteger s = shorter.limbSlice(0, n);
+    BigInteger result;
+    for (size_t i = 0; i < longer.a.size(); i += n) {
+        addTo(result.a, fastMult(longer.limbSlice(i, n), s).a, i);
+    }
+    return result.norm();
+}
+
+int BigInteger::compareSpans(const limb* x, size_t nx, const limb* y, size_t ny) {
+    for (size_t i = std::max(nx, ny); i > 0; --i) {
+        limb xi = i <= nx ? x[i - 1] : 0;
+        limb yi = i <= ny ? y[i - 1] : 0;
+        if (xi != yi) {
+            return xi < yi ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+BigInteger::limb BigInteger::addSpans(limb* r, const limb* x, size_t nx, const limb* y, size_t ny) {
+    limb carry = 0;
+    for (size_t i = 0; i < nx; ++i) {
+        doubleLimb t = static_cast<doubleLimb>(x[i]) + (i < ny ? y[i] : 0) + carry;
+        r[i] = static_cast<limb>(t);
+        carry = static_cast<limb>(t >> LIMB_BITS);
+    }
+    return carry;
+}
+
+BigInteger::limb BigInteger::subSpans(limb* r, const limb* x, size_t nx, const limb* y, size_t ny) {
+    limb borrow = 0;
+    for (size_t i = 0; i < nx; ++i) {
+        limb xi = x[i];
+        limb yi = i < ny ? y[i] : 0;
+        r[i] = xi - yi - borrow;
+        borrow = (xi < yi || (xi == yi && borrow != 0)) ? 1 : 0;
+    }
+    return borrow;
+}
+
+void BigInteger::multSpans(limb* r, const limb* x, size_t nx, const limb* y, size_t ny) {
+    std::fill(r, r + nx + ny, 0);
+    for (size_t i = 0; i < nx; ++i) {
+        limb carry = 0;
+        for (size_t j = 0; j < ny; ++j) {
+            doubleLimb t = static_cast<doubleLimb>(x[i]) * y[j] + r[i + j] + carry;
+            r[i + j] = static_cast<limb>(t);
+            carry = static_cast<limb>(t >> LIMB_BITS);
+        }
+        r[i + ny] = carry;
+    }
+}
+
+size_t BigInteger::karatsubaScratch(size_t n) {
+    size_t size = 0;
+    for (; n > multThresholds().karatsuba; n -= n / 2) {
+        size += 2 * (n - n / 2);
+    }
+    return size;
+}
+
+bool BigInteger::karatsubaDiffs(limb* dx, limb* dy, const limb* x, const limb* y, size_t n) {
+    size_t h = n / 2;
+    size_t hi = n - h;
+    bool xSign = compareSpans(x, h, x + h, hi) >= 0;
+    bool ySign = compareSpans(y + h, hi, y, h) >= 0;
+    if (xSign) {
+        subSpans(dx, x, h, x + h, hi);
+        dx[hi - 1] = hi > h ? 0 : dx[hi - 1];
+    } else {
+        subSpans(dx, x + h, hi, x, h);
+    }
+    if (ySign) {
+        subSpans(dy, y + h, hi, y, h);
+    } else {
+        subSpans(dy, y, h, y + h, hi);
+        dy[hi - 1] = hi > h ? 0 : dy[hi - 1];
+    }
+    return xSign == ySign;
+}
+
+void BigInteger::karatsubaCombine(limb* r, limb* zm, size_t n, bool sameSign) {
+    size_t h = n / 2;
+    size_t hi = n - h;
+    int64_t top = 0;
+    if (sameSign) {
+        top += addSpans(zm, zm, 2 * hi, r + 2 * h, 2 * hi);
+    } else {
+        top -= subSpans(zm, r + 2 * h, 2 * hi, zm, 2 * hi);
+    }
+    top += addSpans(zm, zm, 2 * hi, r, 2 * h);
+    addSpans(r + h, r + h, 2 * n - h, zm, 2 * hi);
+    limb carry = static_cast<limb>(top);
+    addSpans(r + h + 2 * hi, r + h + 2 * hi, 2 * n - h - 2 * hi, &carry, 1);
+}
+
+void BigInteger::karatsubaSpans(limb* r, const limb* x, const limb* y, size_t n, limb* scratch) {
+    if (n <= multThresholds().karatsuba) {
+        multSpans(r, x, n, y, n);
+        return;
+    }
+    size_t h = n / 2;
+    size_t hi = n - h;
+    limb* dx = r;
+    limb* dy = r + hi;
+    limb* zm = scratch;
+    bool sameSign = karatsubaDiffs(dx, dy, x, y, n);
+    karatsubaSpans(zm, dx, dy, hi, scratch + 2 * hi);
+    karatsubaSpans(r, x, y, h, scratch + 2 * hi);
+    karatsubaSpans(r + 2 * h, x + h, y + h, hi, scratch + 2 * hi);
+    karatsubaCombine(r, zm, n, sameSign);
+}
+
+void BigInteger::karatsubaParallel(limb* r, const limb* x, const limb* y, size_t n, size_t tasks) {
+    fft::ThreadPool* pool = threadPool();
+    if (pool == nullptr || n < multThresholds().parallel || n <= multThresholds().karatsuba
+        || tasks >= 4 * pool->size()) {
+        elemVec scratch(karatsubaScratch(n));
+        karatsubaSpans(r, x, y, n, scratch.data());
+        return;
+    }
+    size_t h = n / 2;
+    size_t hi = n - h;
+    elemVec dx(hi);
+    elemVec dy(hi);
+    elemVec zm(2 * hi);
+    bool sameSign = karatsubaDiffs(dx.data(), dy.data(), x, y, n);
+    pool->runAll({
+        [&] { karatsubaParallel(zm.data(), dx.data(), dy.data(), hi, 3 * tasks); },
+        [&] { karatsubaParallel(r, x, y, h, 3 * tasks); },
+        [&] { karatsubaParallel(r + 2 * h, x + h, y + h, hi, 3 * tasks); }
+    });
+    karatsubaCombine(r, zm.data(), n, sameSign);
+}
+
+size_t BigInteger::multScratch(size_t nx, size_t ny) {
+    if (nx < ny) {
+        std::swap(nx, ny);
+    }
+    if (ny <= multThresholds().karatsuba) {
+        return 0;
+    }
+    if (nx == ny) {
+        return karatsubaScratch(ny);
+    }
+    size_t rest = nx % ny == 0 ? 0 : multScratch(ny, nx % ny);
+    return 2 * ny + std::max(karatsubaScratch(ny), rest);
+}
+
+void BigInteger::multSpansFast(limb* r, const limb* x, size_t nx, const limb* y, size_t ny, limb* scratch) {
+    if (nx < ny) {
+        std::swap(x, y);
+        std::swap(nx, ny);
+    }
+    if (ny <= multThresholds().karatsuba) {
+        multSpans(r, x, nx, y, ny);
+        return;
+    }
+    if (nx == ny) {
+        karatsubaSpans(r, x, y, nx, scratch);
+        return;
+    }
+    limb* part = scratch;
+    std::fill(r, r + nx + ny, 0);
+    for (size_t i = 0; i < nx; i += ny) {
+        size_t len = std::min(ny, nx - i);
+        multSpansFast(part, y, ny, x + i, len, scratch + 2 * ny);
+        addSpans(r + i, r + i, nx + ny - i, part, ny + len);
+    }
+}
+
+BigInteger BigInteger::toom3Mult(const BigInteger& x, const BigInteger& y) {
+    size_t k = (std::max(x.a.size(), y.a.size()) + 2) / 3;
+    BigInteger x0 = x.limbSlice(0, k);
+    BigInteger x1 = x.limbSlice(k, k);
+    BigInteger x2 = x.limbSlice(2 * k, k);
+    BigInteger y0 = y.limbSlice(0, k);
+    BigInteger y1 = y.limbSlice(k, k);
+    BigInteger y2 = y.limbSlice(2 * k, k);
+    BigInteger p = x0 + x2;
+    BigInteger q = y0 + y2;
+    BigInteger pm1 = p - x1;
+    BigInteger qm1 = q - y1;
+    BigInteger pm2 = pm1 + x2;
+    BigInteger qm2 = qm1 + y2;
+    pm2.mult(2);
+    qm2.mult(2);
+    pm2 -= x0;
+    qm2 -= y0;
+    BigInteger p1 = p + x1;
+    BigInteger q1 = q + y1;
+    BigInteger r0;
+    BigInteger r1;
+    BigInteger rm1;
+    BigInteger rm2;
+    BigInteger rInf;
+    fft::runAll(k >= multThresholds().parallel ? threadPool() : nullptr, {
+        [&] { r0 = fastMult(x0, y0); },
+        [&] { r1 = fastMult(p1, q1); },
+        [&] { rm1 = fastMult(pm1, qm1); },
+        [&] { rm2 = fastMult(pm2, qm2); },
+        [&] { rInf = fastMult(x2, y2); }
+    });
+    BigInteger r3 = rm2 - r1;
+    divExact(r3, 3);
+    r1 -= rm1;
+    divExact(r1, 2);
+    BigInteger r2 = rm1 - r0;
+    r3 = r2 - r3;
+    divExact(r3, 2);
+    r3 += rInf.multCpy(2);
+    r2 += r1;
+    r2 -= rInf;
+    r1 -= r3;
+    BigInteger result = r0;
+    addTo(result.a, r1.a, k);
+    addTo(result.a, r2.a, 2 * k);
+    addTo(result.a, r3.a, 3 * k);
+    addTo(result.a, rInf.a, 4 * k);
+    return result.norm();
+}
+
+BigInteger fastMult(const BigInteger& x, const BigInteger& y) {
+    const BigInteger::MultThresholds& limits = BigInteger::multThresholds();
     BigInteger result;
-    if (xIn.a.size() == 0 || yIn.a.size() == 0) {
+    size_t minSize = std::min(x.a.size(), y.a.size());
+    size_t maxSize = std::max(x.a.size(), y.a.size());
+    if (minSize == 0) {
         return result;
     }
-    if (xIn.a.size() <= MIN_FAST_MULT_SIZE && yIn.a.size() <= MIN_FAST_MULT_SIZE) {
-        return mult(xIn, yIn);
+    if (minSize <= limits.karatsuba) {
+        return mult(x, y);
     }
-    BigInteger x = xIn;
-    BigInteger y = yIn;
-    if (!x.isPositive || !y.isPositive) {
-        result = fastMult(x.setPositive(), y.setPositive());
-        result.setPositivity(xIn.isPositive == yIn.isPositive);
+    if (minSize >= limits.fft && fft::fitsNtt(2 * x.a.size(), 2 * y.a.size())) {
+        result = x;
+        result.fftMult(y);
         return result;
     }
-    if (x.a.size() != y.a.size()) {
-        size_t maxSize = std::max(x.a.size(), y.a.size());
-        if (maxSize > x.a.size()) {
-            x.a.resize(maxSize, 0);
-        }
-        if (maxSize > y.a.size()) {
-            y.a.resize(maxSize, 0);
+    if (minSize < limits.toom3) {
+        result.a.resize(x.a.size() + y.a.size());
+        if (minSize == maxSize && BigInteger::threadPool() != nullptr) {
+            BigInteger::karatsubaParallel(result.a.data(), x.a.data(), y.a.data(), minSize, 1);
+        } else {
+            BigInteger::elemVec scratch(BigInteger::multScratch(x.a.size(), y.a.size()));
+            BigInteger::multSpansFast(result.a.data(), x.a.data(), x.a.size(), y.a.data(), y.a.size(),
+                scratch.data());
         }
+        result.norm();
+    } else if (maxSize >= 2 * minSize) {
+        result = BigInteger::unbalancedMult(x, y);
+    } else {
+        result = BigInteger::toom3Mult(x, y);
     }
-    size_t partSize = (x.a.size() + 1) / 2;
-    BigInteger a;
-    BigInteger b;
-    BigInteger c;
-    BigInteger d;
-    a.a.resize(partSize);
-    b.a.resize(partSize);
-    c.a.resize(partSize);
-    d.a.resize(partSize);
-    for (size_t i = 0; i < partSize; ++i) {
-        a.a[i] = x.a[i];
-        c.a[i] = y.a[i];
-    }
-    a.norm();
-    c.norm();
-    for (size_t i = 0; i + partSize < x.a.size(); ++i) {
-        b.a[i] = x.a[i + partSize];
-        d.a[i] = y.a[i + partSize];
-    }
-    b.norm();
-    d.norm();
-    BigInteger ac = fastMult(a, c);
-    BigInteger bd = fastMult(b, d);
-    result = (bd << (2 * partSize)) + (((fastMult(a + b, c + d) - ac - bd).norm()) << partSize) + ac;
-    result.norm();
+    result.setPositivity(x.isPositive == y.isPositive);
     return result;
 }
 
-BigInteger& BigInteger::operator+=(const BigInteger& x) {
-    BigInteger y;
-    bool numChanged;
-    if (getsetPositiveed() < x.getsetPositiveed()) {
-        y = *this;
-        operator=(x);
+BigInteger& BigInteger::addSigned(const BigInteger& x, bool xPositive) {
+    if (a.size() == 0) {
+        isPositive = xPositive;
+    }
+    if (isPositive == xPositive) {
+        addTo(a, x.a);
+    } else if (compare(a, x.a) >= 0) {
+        subFrom(a, x.a);
     } else {
-        y = x;
-    }
-    numChanged = true;
-    for (size_t i = 0; numChanged && i < a.size(); ++i) {
-        if (i < y.a.size()) {
-            a[i] += ((isPositive == y.isPositive) ? 1 : -1) * y.a[i];
-            numChanged = true;
-        }
-        if (a[i] < 0) {
-            if (i + 1 != a.size()) {
-                a[i + 1] -= 1;
-                a[i] += MEMBER_SIZE;
+        elemVec y = x.a;
+        subFrom(y, a);
+        a.swap(y);
+        isPositive = xPositive;
+    }
+    norm();
+    return *this;
+}
+
+BigInteger& BigInteger::addProduct(const BigInteger& y, const BigInteger& z, bool negate) {
+    bool productPositive = (y.isPositive == z.isPositive) != negate;
+    if (a.size() == 0) {
+        isPositive = productPositive;
+    }
+    if (isPositive == productPositive && (y.a.size() == 1 || z.a.size() == 1)) {
+        const BigInteger& big = y.a.size() == 1 ? z : y;
+        limb m = y.a.size() == 1 ? y.a[0] : z.a[0];
+        addMulSmall(a, big.a, m);
+        return norm();
+    }
+    BigInteger p = fastMult(y, z);
+    return addSigned(p, productPositive);
+}
+
+std::vector<bool> BigInteger::toBits() const {
+    std::vector<bool> bits(a.size() * LIMB_BITS);
+    for (size_t i = 0; i < bits.size(); ++i) {
+        bits[i] = (a[i / LIMB_BITS] >> (i % LIMB_BITS)) & 1;
+    }
+    while (!bits.empty() && !bits.back()) {
+        bits.pop_back();
+    }
+    return bits;
+}
+
+BigInteger& addmul(BigInteger& x, const BigInteger& y, const BigInteger& z) {
+    return x.addProduct(y, z, false);
+}
+
+BigInteger& submul(BigInteger& x, const BigInteger& y, const BigInteger& z) {
+    return x.addProduct(y, z, true);
+}
+
+const BigInteger& BigInteger::decPower(size_t k) {
+    static std::deque<BigInteger> powers;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (powers.empty()) {
+        limb member = DEC_MEMBER_SIZE;
+        powers.emplace_back();
+        powers.back().a.push_back(member);
+    }
+    while (powers.size() <= k) {
+        powers.push_back(powers.back() * powers.back());
+    }
+    return powers[k];
+}
+
+BigInteger BigInteger::fromDecimal(const char* s, size_t len) {
+    BigInteger result;
+    if (len <= DEC_SPLIT_LIMBS * DEC_MEMBER_POW) {
+        size_t first = len % DEC_MEMBER_POW;
+        for (size_t i = 0; i < len;) {
+            size_t end = (i == 0 && first != 0) ? first : i + DEC_MEMBER_POW;
+            limb chunk = 0;
+            limb scale = 1;
+            for (; i < end; ++i) {
+                chunk = chunk * BASIS + (s[i] - '0');
+                scale *= BASIS;
             }
-            numChanged = true;
-        }
-        if (a[i] >= MEMBER_SIZE) {
-            if (i + 1 == a.size()) {
-                a.push_back(0);
+            multSmall(result.a, scale, chunk);
+            if (result.a.size() == 1 && result.a[0] == 0) {
+                result.a.clear();
             }
-            a[i + 1] += a[i] / MEMBER_SIZE;
-            a[i] %= MEMBER_SIZE;
-            numChanged = true;
         }
+        return result.norm();
     }
-    norm();
-    return *this;
+    size_t k = 0;
+    while ((DEC_MEMBER_POW << (k + 1)) < len) {
+        ++k;
+    }
+    size_t lowLen = DEC_MEMBER_POW << k;
+    result = fastMult(fromDecimal(s, len - lowLen), decPower(k));
+    result += fromDecimal(s + len - lowLen, lowLen);
+    return result;
+}
+
+template<typename Sink>
+void BigInteger::writeDecimalPart(const elemVec& x, size_t pad, Sink& sink) {
+    static const char ZEROS[] = "0000000000000000000";
+    if (x.size() <= DEC_SPLIT_LIMBS) {
+        std::vector<limb> chunks;
+        elemVec y = x;
+        while (y.size() > 0) {
+            chunks.push_back(divSmall(y, DEC_MEMBER_SIZE));
+        }
+        for (size_t written = chunks.size() * DEC_MEMBER_POW; written < pad; written += DEC_MEMBER_POW) {
+            sink(ZEROS, pad - written < DEC_MEMBER_POW ? pad - written : DEC_MEMBER_POW);
+        }
+        char buf[DEC_MEMBER_POW];
+        for (size_t i = chunks.size(); i > 0; --i) {
+            size_t pos = DEC_MEMBER_POW;
+            for (limb c = chunks[i - 1]; c > 0; c /= BASIS) {
+                buf[--pos] = static_cast<char>('0' + c % BASIS);
+            }
+            if (pad != 0 || i != chunks.size()) {
+                for (; pos > 0;) {
+                    buf[--pos] = '0';
+                }
+            }
+            sink(buf + pos, DEC_MEMBER_POW - pos);
+        }
+        return;
+    }
+    size_t k = 0;
+    while (decPower(k + 1).a.size() * 2 <= x.size()) {
+        ++k;
+    }
+    size_t lowLen = DEC_MEMBER_POW << k;
+    elemVec q;
+    elemVec r;
+    divMod(x, decPower(k).a, q, r);
+    writeDecimalPart(q, pad == 0 ? 0 : pad - lowLen, sink);
+    writeDecimalPart(r, lowLen, sink);
 }
 
 BigInteger fftMult(const BigInteger& a, const BigInteger& b) {
@@ -620,6 +1660,176 @@ BigInteger fftMult(const BigInteger& a, const BigInteger& b) {
     return c;
 }
 
+template<typename T, typename Mul>
+T slidingWindowPow(const T& base, const T& one, const std::vector<bool>& bits, Mul mul) {
+    size_t window = bits.size() <= 256 ? 4 : (bits.size() <= 1024 ? 5 : 6);
+    std::vector<T> table(size_t(1) << (window - 1), base);
+    T square = base;
+    mul(square, base, base);
+    for (size_t i = 1; i < table.size(); ++i) {
+        mul(table[i], table[i - 1], square);
+    }
+    T acc = one;
+    T tmp = one;
+    for (size_t i = bits.size(); i > 0;) {
+        if (!bits[i - 1]) {
+            mul(tmp, acc, acc);
+            acc.swap(tmp);
+            --i;
+            continue;
+        }
+        size_t low = i > window ? i - window : 0;
+        while (!bits[low]) {
+            ++low;
+        }
+        size_t value = 0;
+        for (size_t j = i; j > low; --j) {
+            value = value * 2 + bits[j - 1];
+            mul(tmp, acc, acc);
+            acc.swap(tmp);
+        }
+        mul(tmp, acc, table[value / 2]);
+        acc.swap(tmp);
+        i = low;
+    }
+    return acc;
+}
+
+class MontgomeryContext {
+private:
+    using limb = BigInteger::limb;
+    using doubleLimb = BigInteger::doubleLimb;
+    using elemVec = BigInteger::elemVec;
+
+    BigInteger m;
+    size_t n;
+    limb mInv;
+    elemVec r2;
+    elemVec one;
+
+    void reduceIfNeeded(limb* t) const {
+        if (t[n] != 0 || BigInteger::compareSpans(t, n, m.a.data(), n) >= 0) {
+            BigInteger::subSpans(t, t, n, m.a.data(), n);
+        }
+    }
+
+    elemVec padded(const BigInteger& x) const {
+        BigInteger y = x % m;
+        if (!y.isPositive) {
+            y += m;
+        }
+        elemVec v = y.a;
+        v.resize(n, 0);
+        return v;
+    }
+
+public:
+    explicit MontgomeryContext(const BigInteger& modulus) : m(modulus.getsetPositiveed()), n(m.a.size()) {
+        limb m0 = m.a.size() > 0 ? m.a[0] : 1;
+        limb inv = m0;
+        for (int i = 0; i < 5; ++i) {
+            inv *= 2 - m0 * inv;
+        }
+        mInv = 0 - inv;
+        BigInteger r = BigInteger::limbPower(2 * n) % m;
+        r2 = r.a;
+        r2.resize(n, 0);
+        one = elemVec(n, 0);
+        if (n > 0) {
+            one[0] = 1;
+            elemVec t(n);
+            multiply(t, one, r2);
+            one = t;
+        }
+    }
+
+    const BigInteger& modulus() const {
+        return m;
+    }
+
+    bool valid() const {
+        return n > 0 && (m.a[0] & 1) == 1 && m != 1;
+    }
+
+    void multiply(elemVec& r, const elemVec& x, const elemVec& y) const {
+        elemVec t(n + 2);
+        multiply(r, x, y, t);
+    }
+
+    void multiply(elemVec& r, const elemVec& x, const elemVec& y, elemVec& t) const {
+        std::fill(t.begin(), t.end(), 0);
+        const limb* mod = m.a.data();
+        const limb* xs = x.data();
+        const limb* ys = y.data();
+        limb* ts = t.data();
+        for (size_t i = 0; i < n; ++i) {
+            limb carry = 0;
+            for (size_t j = 0; j < n; ++j) {
+                doubleLimb c = static_cast<doubleLimb>(xs[i]) * ys[j] + ts[j] + carry;
+                ts[j] = static_cast<limb>(c);
+                carry = static_cast<limb>(c >> BigInteger::LIMB_BITS);
+            }
+            doubleLimb c = static_cast<doubleLimb>(ts[n]) + carry;
+            ts[n] = static_cast<limb>(c);
+            ts[n + 1] = static_cast<limb>(c >> BigInteger::LIMB_BITS);
+            limb u = ts[0] * mInv;
+            c = static_cast<doubleLimb>(u) * mod[0] + ts[0];
+            carry = static_cast<limb>(c >> BigInteger::LIMB_BITS);
+            for (size_t j = 1; j < n; ++j) {
+                c = static_cast<doubleLimb>(u) * mod[j] + ts[j] + carry;
+                ts[j - 1] = static_cast<limb>(c);
+                carry = static_cast<limb>(c >> BigInteger::LIMB_BITS);
+            }
+            c = static_cast<doubleLimb>(ts[n]) + carry;
+            ts[n - 1] = static_cast<limb>(c);
+            ts[n] = ts[n + 1] + static_cast<limb>(c >> BigInteger::LIMB_BITS);
+        }
+        reduceIfNeeded(t.data());
+        r.assign(t.begin(), t.begin() + n);
+    }
+
+    elemVec toMontgomery(const BigInteger& x) const {
+        elemVec v = padded(x);
+        elemVec r(n);
+        multiply(r, v, r2);
+        return r;
+    }
+
+    BigInteger fromMontgomery(const elemVec& x) const {
+        elemVec unit(n, 0);
+        unit[0] = 1;
+        BigInteger r;
+        multiply(r.a, x, unit);
+        return r.norm();
+    }
+
+    BigInteger pow(const BigInteger& base, const BigInteger& exp) const {
+        if (!valid() || !exp.isPositive) {
+            return powMod(base, exp, m);
+        }
+        elemVec t(n + 2);
+        elemVec result = slidingWindowPow(toMontgomery(base), one, exp.toBits(),
+            [this, &t](elemVec& r, const elemVec& x, const elemVec& y) { multiply(r, x, y, t); });
+        return fromMontgomery(result);
+    }
+};
+
+BigInteger powMod(const BigInteger& base, const BigInteger& exp, const BigInteger& m) {
+    BigInteger mod = m.getsetPositiveed();
+    if (mod == 0 || mod == 1 || !exp.isPositive) {
+        return 0;
+    }
+    if ((mod.a[0] & 1) == 1) {
+        return MontgomeryContext(mod).pow(base, exp);
+    }
+    BigInteger b = base % mod;
+    if (!b.isPositive) {
+        b += mod;
+    }
+    return slidingWindowPow(b, BigInteger(1), exp.toBits(),
+        [&mod](BigInteger& r, const BigInteger& x, const BigInteger& y) { r = x * y % mod; });
+}
+
 class Rational {
 protected:
     BigInteger top;
@@ -645,6 +1855,9 @@ public:
     Rational() {}
     Rational(const BigInteger& x) : top(x) {}
     Rational(const Rational& x) : top(x.top), bottom(x.bottom) {}
+    Rational(Rational&& x) noexcept : top(std::move(x.top)), bottom(std::move(x.bottom)) {
+        x.bottom = 1;
+    }
     Rational(int x) : top(x) {}
 
     explicit operator double() {
@@ -663,21 +1876,35 @@ public:
     }
 
     Rational& operator=(const Rational& x) {
-        Rational cp = x;
-        swap(cp);
+        top = x.top;
+        bottom = x.bottom;
+        return *this;
+    }
+
+    Rational& operator=(Rational&& x) noexcept {
+        if (this != &x) {
+            top = std::move(x.top);
+            bottom = std::move(x.bottom);
+            x.bottom = 1;
+        }
         return *this;
     }
 
     Rational& operator+=(const Rational& x) {
-        top *= x.bottom;
-        top += bottom * x.top;
+        BigInteger t = top * x.bottom;
+        addmul(t, bottom, x.top);
+        top = std::move(t);
         bottom *= x.bottom;
         norm();
         return *this;
     }
 
     Rational& operator-=(const Rational& x) {
-        operator+=(-x);
+        BigInteger t = top * x.bottom;
+        submul(t, bottom, x.top);
+        top = std::move(t);
+        bottom *= x.bottom;
+        norm();
         return *this;
     }
 
@@ -704,8 +1931,7 @@ public:
     }
 
     std::string asDecimal(size_t precision = 0) const {
-        static const int DEC_BASIS = 10;
-        std::string s = (top * BigInteger(DEC_BASIS, precision) / bottom).setPositive().toString();
+        std::string s = (top * BigInteger::powerOfTen(precision) / bottom).setPositive().toString();
         if (s.size() <= precision) {
             if (s.size() < precision) {
                 std::string t(precision - s.size(), '0');
@@ -727,24 +1953,44 @@ Rational operator+(const Rational& x, const Rational& y) {
     return cp;
 }
 
+Rational operator+(Rational&& x, const Rational& y) {
+    x += y;
+    return std::move(x);
+}
+
 Rational operator-(const Rational& x, const Rational& y) {
     Rational cp = x;
     cp -= y;
     return cp;
 }
 
+Rational operator-(Rational&& x, const Rational& y) {
+    x -= y;
+    return std::move(x);
+}
+
 Rational operator*(const Rational& x, const Rational& y) {
     Rational cp = x;
     cp *= y;
     return cp;
 }
 
+Rational operator*(Rational&& x, const Rational& y) {
+    x *= y;
+    return std::move(x);
+}
+
 Rational operator/(const Rational& x, const Rational& y) {
     Rational cp = x;
     cp /= y;
     return cp;
 }
 
+Rational operator/(Rational&& x, const Rational& y) {
+    x /= y;
+    return std::move(x);
+}
+
 bool operator==(const Rational& x, const Rational& y) {
     return x.top == y.top && x.bottom == y.bottom;
 }
@@ -0,0 +1,130 @@
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "biginteger.h"
+
+using Clock = std::chrono::steady_clock;
+
+const double MIN_MEASURE_SECONDS = 0.01;
+const int MEASURE_ROUNDS = 5;
+const size_t NEVER = size_t(1) << 40;
+const int CONFIRMATIONS = 2;
+const double MIN_GAIN = 0.03;
+
+std::mt19937_64 rnd(42);
+
+BigInteger randomNumber(size_t limbs) {
+    const size_t DIGITS_PER_LIMB = 19;
+    std::string s((limbs - 1) * DIGITS_PER_LIMB + 1, '0');
+    for (size_t i = 0; i < s.size(); ++i) {
+        s[i] = static_cast<char>('0' + rnd() % 10);
+    }
+    return (BigInteger(1) << static_cast<uint>(limbs - 1)) + BigInteger(s);
+}
+
+double measure(const BigInteger &x, const BigInteger &y) {
+    double best = 0;
+    BigInteger result;
+    for (int round = 0; round < MEASURE_ROUNDS; ++round) {
+        size_t reps = 0;
+        Clock::time_point start = Clock::now();
+        std::chrono::duration<double> time(0);
+        for (; time.count() < MIN_MEASURE_SECONDS; ++reps) {
+            result = fastMult(x, y);
+            time = Clock::now() - start;
+        }
+        double perCall = time.count() / reps;
+        if (round == 0 || perCall < best) {
+            best = perCall;
+        }
+    }
+    return best;
+}
+
+template<typename OldSetter, typename NewSetter>
+size_t crossover(size_t from, size_t to, OldSetter setOld, NewSetter setNew) {
+    int wins = 0;
+    size_t first = to;
+    for (size_t n = from; n <= to; n += n / 8 + 1) {
+        BigInteger x = randomNumber(n);
+        BigInteger y = randomNumber(n);
+        setOld(n);
+        double oldTime = measure(x, y);
+        setNew(n);
+        double newTime = measure(x, y);
+        std::cerr << n << " limbs: " << oldTime * 1e6 << " us -> " << newTime * 1e6 << " us\n";
+        if (newTime < oldTime * (1 - MIN_GAIN)) {
+            if (wins == 0) {
+                first = n;
+            }
+            if (++wins == CONFIRMATIONS) {
+                return first;
+            }
+        } else {
+            wins = 0;
+            first = to;
+        }
+    }
+    return first;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <directory of biginteger.h>/biginteger_tuning.h\n";
+        return 1;
+    }
+    std::string path = argv[1];
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "cannot write " << path << '\n';
+        return 1;
+    }
+    BigInteger::MultThresholds &limits = BigInteger::multThresholds();
+    limits.toom3 = NEVER;
+    limits.fft = NEVER;
+
+    std::cerr << "karatsuba\n";
+    size_t karatsuba = crossover(8, 256,
+        [&](size_t n) { limits.karatsuba = n; },
+        [&](size_t n) { limits.karatsuba = n - 1; });
+    limits.karatsuba = karatsuba;
+
+    std::cerr << "toom3\n";
+    size_t toom3 = crossover(3 * karatsuba, 4096,
+        [&](size_t n) { limits.toom3 = n + 1; },
+        [&](size_t n) { limits.toom3 = n; });
+    limits.toom3 = toom3;
+
+    std::cerr << "fft\n";
+    size_t fft = crossover(toom3, 1 << 16,
+        [&](size_t n) { limits.fft = n + 1; },
+        [&](size_t n) { limits.fft = n; });
+    limits.fft = fft;
+
+    std::cerr << "parallel\n";
+    fft::ThreadPool pool;
+    size_t parallel = NEVER;
+    if (pool.size() > 1) {
+        BigInteger::setThreadPool(&pool);
+        parallel = crossover(2 * karatsuba, 1 << 16,
+            [&](size_t n) { limits.parallel = n + 1; },
+            [&](size_t n) { limits.parallel = n; });
+        BigInteger::setThreadPool(nullptr);
+    }
+
+    out << "#define BIGINTEGER_KARATSUBA_LIMBS " << karatsuba << '\n';
+    out << "#define BIGINTEGER_TOOM3_LIMBS " << toom3 << '\n';
+    out << "#define BIGINTEGER_FFT_LIMBS " << fft << '\n';
+    out << "#define BIGINTEGER_PARALLEL_LIMBS " << parallel << '\n';
+    out.close();
+    if (!out) {
+        std::cerr << "cannot write " << path << '\n';
+        return 1;
+    }
+    std::cout << "karatsuba " << karatsuba << ", toom3 " << toom3 << ", fft " << fft << ", parallel " << parallel
+        << " -> " << path << '\n';
+}
@@ -1,11 +1,24 @@
+#include <algorithm>
 #include <complex>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FFT_X86_KERNELS
+#endif
+
+#include "residue.h"
+#include "threadpool.h"
+
 namespace fft
 {
     using comp = std::complex<double>;
     using Polynom = std::vector<int>;
     using CompPolynom = std::vector<comp>;
+    using LongPolynom = std::vector<int64_t>;
 
     const long double PI = acosl(-1);
     const comp cI = comp(0, 1); 
@@ -55,6 +68,11 @@ namespace fft
         return x;
     }
 
+    ThreadPool& defaultPool() {
+        static ThreadPool pool;
+        return pool;
+    }
+
     comp getKCompRoot(size_t n, int k) {
         double angle = (2 * PI * k) / n;
         return comp(std::cos(angle), std::sin(angle));
@@ -70,6 +88,107 @@ namespace fft
         return ans;
     }
 
+    template<typename T>
+    using TrigReal = typename std::conditional<(sizeof(T) > sizeof(double)), long double, double>::type;
+
+    template<typename T>
+    std::vector<std::complex<T> > rootTable(size_t n) {
+        using Comp = std::complex<T>;
+        std::vector<Comp> roots(std::max(n, size_t(1)), 1);
+        size_t top = n / 2;
+        if (top < 4) {
+            for (size_t i = 0; i < top; ++i) {
+                TrigReal<T> angle = static_cast<TrigReal<T> >(PI) * i / top;
+                roots[top + i] = Comp(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+            }
+        } else {
+            Comp *w = roots.data() + top;
+            for (size_t i = 0; i <= top / 4; ++i) {
+                TrigReal<T> angle = static_cast<TrigReal<T> >(PI) * i / top;
+                w[i] = Comp(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+            }
+            for (size_t i = top / 4 + 1; i <= top / 2; ++i) {
+                w[i] = Comp(w[top / 2 - i].imag(), w[top / 2 - i].real());
+            }
+            for (size_t i = top / 2 + 1; i < top; ++i) {
+                w[i] = Comp(-w[top - i].real(), w[top - i].imag());
+            }
+        }
+        for (size_t half = top / 2; half >= 1; half /= 2) {
+            for (size_t i = 0; i < half; ++i) {
+                roots[half + i] = roots[2 * half + 2 * i];
+            }
+        }
+        return roots;
+    }
+
+    template<typename T>
+    class BasicPlan {
+    private:
+        using Comp = std::complex<T>;
+
+        size_t n = 1;
+        std::vector<size_t> rev;
+        std::vector<Comp> roots;
+
+        void transform(Comp *p, bool back) const {
+            for (size_t i = 0; i < n; ++i) {
+                if (i < rev[i]) {
+                    std::swap(p[i], p[rev[i]]);
+                }
+            }
+            for (size_t half = 1; half < n; half *= 2) {
+                const Comp *w = roots.data() + half;
+                for (size_t j = 0; j < n; j += 2 * half) {
+                    Comp *x = p + j;
+                    Comp *y = p + j + half;
+                    for (size_t i = 0; i < half; ++i) {
+                        Comp c = back ? std::conj(w[i]) : w[i];
+                        Comp ac = x[i];
+                        Comp bc = c * y[i];
+                        x[i] = ac + bc;
+                        y[i] = ac - bc;
+                    }
+                }
+            }
+        }
+    public:
+        BasicPlan() : rev(1, 0), roots(1, 1) {}
+
+        explicit BasicPlan(size_t size) : n(size), rev(size, 0), roots(rootTable<T>(size)) {
+            size_t num = 0;
+            for (size_t i = n; i > 1; i /= 2, ++num) {}
+            for (size_t i = 1; i < n; ++i) {
+                rev[i] = (rev[i / 2] / 2) | ((i & 1) << (num - 1));
+            }
+        }
+
+        size_t size() const {
+            return n;
+        }
+
+        void fft(Comp *p) const {
+            transform(p, false);
+        }
+
+        void fftBack(Comp *p) const {
+            transform(p, true);
+            for (size_t i = 0; i < n; ++i) {
+                p[i] /= static_cast<T>(n);
+            }
+        }
+
+        void fft(std::vector<Comp> &p) const {
+            fft(p.data());
+        }
+
+        void fftBack(std::vector<Comp> &p) const {
+            fftBack(p.data());
+        }
+    };
+
+    using Plan = BasicPlan<double>;
+
     CompPolynom fft(CompPolynom p, comp w) {
         if (p.size() == 1) {
             return p;
@@ -105,30 +224,1314 @@ namespace fft
         return p;
     }
 
-    CompPolynom fft(const CompPolynom &p) {
-        return fft(p, getKCompRoot(p.size(), 1));
+    const double MIXED_RADIX_COST = 1.25;
+
+    size_t goodSize(size_t s) {
+        size_t power;
+        for (power = 1; power < s; power *= 2) {}
+        size_t best = power;
+        for (size_t p5 = 1; p5 < power; p5 *= 5) {
+            for (size_t p3 = p5; p3 < power; p3 *= 3) {
+                size_t x = p3;
+                for (; x < s; x *= 2) {}
+                best = std::min(best, x);
+            }
+        }
+        return best * MIXED_RADIX_COST < power ? best : power;
     }
 
-    CompPolynom fftBack(const CompPolynom &p) {
-        CompPolynom x = fft(p, getKCompRoot(p.size(), -1));
-        for (size_t i = 0; i < x.size(); ++i) {
-            x[i] /= p.size();
+    template<typename T>
+    class BasicBluesteinPlan {
+    private:
+        using Comp = std::complex<T>;
+
+        size_t n = 0;
+        BasicPlan<T> plan;
+        std::vector<Comp> chirp;
+        std::vector<Comp> kernel;
+    public:
+        BasicBluesteinPlan() = default;
+
+        explicit BasicBluesteinPlan(size_t size) : n(size), chirp(size) {
+            size_t m;
+            for (m = 1; m + 1 < 2 * n; m *= 2) {}
+            plan = BasicPlan<T>(m);
+            kernel.assign(m, 0);
+            for (size_t j = 0; j < n; ++j) {
+                TrigReal<T> angle = static_cast<TrigReal<T> >(PI) * ((j * j) % (2 * n)) / n;
+                chirp[j] = Comp(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+                kernel[j] = kernel[(m - j) % m] = std::conj(chirp[j]);
+            }
+            plan.fft(kernel);
         }
-        return x;
+
+        size_t size() const {
+            return n;
+        }
+
+        void fft(Comp *p) const {
+            std::vector<Comp> x(plan.size(), 0);
+            for (size_t i = 0; i < n; ++i) {
+                x[i] = p[i] * chirp[i];
+            }
+            plan.fft(x);
+            for (size_t i = 0; i < x.size(); ++i) {
+                x[i] *= kernel[i];
+            }
+            plan.fftBack(x);
+            for (size_t i = 0; i < n; ++i) {
+                p[i] = x[i] * chirp[i];
+            }
+        }
+
+        void fftBack(Comp *p) const {
+            for (size_t i = 0; i < n; ++i) {
+                p[i] = std::conj(p[i]);
+            }
+            fft(p);
+            for (size_t i = 0; i < n; ++i) {
+                p[i] = std::conj(p[i]) / static_cast<T>(n);
+            }
+        }
+
+        void fft(std::vector<Comp> &p) const {
+            fft(p.data());
+        }
+
+        void fftBack(std::vector<Comp> &p) const {
+            fftBack(p.data());
+        }
+    };
+
+    using BluesteinPlan = BasicBluesteinPlan<double>;
+
+    template<typename T>
+    class BasicMixedPlan {
+    private:
+        using Comp = std::complex<T>;
+
+        size_t n = 1;
+        std::vector<size_t> factors;
+        std::vector<Comp> twiddles;
+        BasicBluesteinPlan<T> bluestein;
+
+        template<size_t R>
+        static void butterfly(Comp *a, T sign) {
+            auto rotate = [sign](Comp z) { return Comp(-sign * z.imag(), sign * z.real()); };
+            if (R == 2) {
+                Comp t = a[1];
+                a[1] = a[0] - t;
+                a[0] += t;
+            } else if (R == 3) {
+                const T s = static_cast<T>(0.866025403784438646763723170752936183L);
+                Comp t1 = a[1] + a[2];
+                Comp t2 = a[0] - t1 * static_cast<T>(0.5);
+                Comp t3 = rotate(a[1] - a[2]) * s;
+                a[0] += t1;
+                a[1] = t2 + t3;
+                a[2] = t2 - t3;
+            } else if (R == 4) {
+                Comp t0 = a[0] + a[2];
+                Comp t1 = a[0] - a[2];
+                Comp t2 = a[1] + a[3];
+                Comp t3 = rotate(a[1] - a[3]);
+                a[0] = t0 + t2;
+                a[1] = t1 + t3;
+                a[2] = t0 - t2;
+                a[3] = t1 - t3;
+            } else {
+                const T c1 = static_cast<T>(0.309016994374947424102293417182819059L);
+                const T c2 = static_cast<T>(-0.809016994374947424102293417182819059L);
+                const T s1 = static_cast<T>(0.951056516295153572116439333379382143L);
+                const T s2 = static_cast<T>(0.587785252292473129168705954639072769L);
+                Comp s14 = a[1] + a[4];
+                Comp d14 = a[1] - a[4];
+                Comp s23 = a[2] + a[3];
+                Comp d23 = a[2] - a[3];
+                Comp u1 = a[0] + s14 * c1 + s23 * c2;
+                Comp u2 = a[0] + s14 * c2 + s23 * c1;
+                Comp v1 = rotate(d14 * s1 + d23 * s2);
+                Comp v2 = rotate(d14 * s2 - d23 * s1);
+                a[0] += s14 + s23;
+                a[1] = u1 + v1;
+                a[2] = u2 + v2;
+                a[3] = u2 - v2;
+                a[4] = u1 - v1;
+            }
+        }
+
+        template<size_t R>
+        static void pass(const Comp *x, Comp *y, size_t m, size_t stride, const Comp *w, bool back) {
+            T sign = back ? -1 : 1;
+            Comp a[R];
+            Comp c[R];
+            for (size_t p = 0; p < m; ++p) {
+                for (size_t u = 1; u < R; ++u) {
+                    c[u] = back ? std::conj(w[p * (R - 1) + u - 1]) : w[p * (R - 1) + u - 1];
+                }
+                const Comp *in = x + stride * p;
+                Comp *out = y + stride * R * p;
+                for (size_t q = 0; q < stride; ++q) {
+                    for (size_t t = 0; t < R; ++t) {
+                        a[t] = in[q + t * stride * m];
+                    }
+                    butterfly<R>(a, sign);
+                    out[q] = a[0];
+                    for (size_t u = 1; u < R; ++u) {
+                        out[q + u * stride] = a[u] * c[u];
+                    }
+                }
+            }
+        }
+
+        void transform(Comp *p, Comp *buffer, bool back) const {
+            const Comp *w = twiddles.data();
+            Comp *x = p;
+            Comp *y = buffer;
+            size_t stride = 1;
+            size_t length = n;
+            for (size_t r : factors) {
+                size_t m = length / r;
+                if (r == 2) {
+                    pass<2>(x, y, m, stride, w, back);
+                } else if (r == 3) {
+                    pass<3>(x, y, m, stride, w, back);
+                } else if (r == 4) {
+                    pass<4>(x, y, m, stride, w, back);
+                } else {
+                    pass<5>(x, y, m, stride, w, back);
+                }
+                w += m * (r - 1);
+                stride *= r;
+                length = m;
+                std::swap(x, y);
+            }
+            if (x != p) {
+                std::copy(x, x + n, p);
+            }
+        }
+    public:
+        explicit BasicMixedPlan(size_t size) : n(size) {
+            size_t rest = n;
+            for (size_t r : {4, 2, 3, 5}) {
+                for (; rest % r == 0; rest /= r) {
+                    factors.push_back(r);
+                }
+            }
+            if (rest > 1) {
+                factors.clear();
+                bluestein = BasicBluesteinPlan<T>(n);
+                return;
+            }
+            std::vector<Comp> roots(n);
+            size_t quarter = n % 4 == 0 ? n / 4 : n / 2;
+            for (size_t i = 0; i <= quarter && i < n; ++i) {
+                TrigReal<T> angle = 2 * static_cast<TrigReal<T> >(PI) * i / n;
+                roots[i] = Comp(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+            }
+            for (size_t i = quarter + 1; i <= n / 2; ++i) {
+                roots[i] = Comp(-roots[i - quarter].imag(), roots[i - quarter].real());
+            }
+            for (size_t i = n / 2 + 1; i < n; ++i) {
+                roots[i] = std::conj(roots[n - i]);
+            }
+            twiddles.reserve(2 * n);
+            size_t length = n;
+            for (size_t r : factors) {
+                size_t m = length / r;
+                for (size_t p = 0; p < m; ++p) {
+                    for (size_t u = 1; u < r; ++u) {
+                        twiddles.push_back(roots[p * u * (n / length)]);
+                    }
+                }
+                length = m;
+            }
+        }
+
+        size_t size() const {
+            return n;
+        }
+
+        void fft(Comp *p, Comp *buffer) const {
+            if (bluestein.size() > 0) {
+                bluestein.fft(p);
+            } else {
+                transform(p, buffer, false);
+            }
+        }
+
+        void fftBack(Comp *p, Comp *buffer) const {
+            if (bluestein.size() > 0) {
+                bluestein.fftBack(p);
+                return;
+            }
+            transform(p, buffer, true);
+            for (size_t i = 0; i < n; ++i) {
+                p[i] /= static_cast<T>(n);
+            }
+        }
+
+        void fft(std::vector<Comp> &p) const {
+            std::vector<Comp> buffer(n);
+            fft(p.data(), buffer.data());
+        }
+
+        void fftBack(std::vector<Comp> &p) const {
+            std::vector<Comp> buffer(n);
+            fftBack(p.data(), buffer.data());
+        }
+    };
+
+    using MixedPlan = BasicMixedPlan<double>;
+
+    const size_t SIX_STEP_MIN_SIZE = 1 << 24;
+
+    void transposeBlocked(const comp *src, comp *dst, size_t rows, size_t cols) {
+        const size_t BLOCK = 32;
+        for (size_t i0 = 0; i0 < rows; i0 += BLOCK) {
+            for (size_t j0 = 0; j0 < cols; j0 += BLOCK) {
+                size_t i1 = std::min(i0 + BLOCK, rows);
+                size_t j1 = std::min(j0 + BLOCK, cols);
+                for (size_t i = i0; i < i1; ++i) {
+                    for (size_t j = j0; j < j1; ++j) {
+                        dst[j * rows + i] = src[i * cols + j];
+                    }
+                }
+            }
+        }
+    }
+
+    class SixStepPlan {
+    private:
+        size_t n = 1;
+        size_t n1 = 1;
+        size_t n2 = 1;
+        Plan plan1;
+        Plan plan2;
+        CompPolynom twiddles;
+        CompPolynom buffer;
+
+        void transform(comp *p, bool back) {
+            comp *q = buffer.data();
+            transposeBlocked(p, q, n1, n2);
+            for (size_t j2 = 0; j2 < n2; ++j2) {
+                comp *row = q + j2 * n1;
+                const comp *w = twiddles.data() + j2 * n1;
+                if (back) {
+                    plan1.fftBack(row);
+                    for (size_t k1 = 0; k1 < n1; ++k1) {
+                        row[k1] *= std::conj(w[k1]);
+                    }
+                } else {
+                    plan1.fft(row);
+                    for (size_t k1 = 0; k1 < n1; ++k1) {
+                        row[k1] *= w[k1];
+                    }
+                }
+            }
+            transposeBlocked(q, p, n2, n1);
+            for (size_t k1 = 0; k1 < n1; ++k1) {
+                if (back) {
+                    plan2.fftBack(p + k1 * n2);
+                } else {
+                    plan2.fft(p + k1 * n2);
+                }
+            }
+            transposeBlocked(p, q, n1, n2);
+            std::copy(q, q + n, p);
+        }
+    public:
+        explicit SixStepPlan(size_t size) : n(size) {
+            size_t num = 0;
+            for (size_t i = n; i > 1; i /= 2, ++num) {}
+            n1 = size_t(1) << (num / 2);
+            n2 = n / n1;
+            plan1 = Plan(n1);
+            plan2 = Plan(n2);
+            buffer.resize(n);
+            twiddles.resize(n);
+            CompPolynom table = rootTable<double>(n);
+            size_t top = n / 2;
+            for (size_t j2 = 0; j2 < n2; ++j2) {
+                for (size_t k1 = 0; k1 < n1; ++k1) {
+                    size_t m = j2 * k1;
+                    twiddles[j2 * n1 + k1] = m >= top && top > 0 ? -table[m] : table[top + m];
+                }
+            }
+        }
+
+        size_t size() const {
+            return n;
+        }
+
+        void fft(comp *p) {
+            transform(p, false);
+        }
+
+        void fftBack(comp *p) {
+            transform(p, true);
+        }
+
+        void fft(CompPolynom &p) {
+            fft(p.data());
+        }
+
+        void fftBack(CompPolynom &p) {
+            fftBack(p.data());
+        }
+    };
+
+    CompPolynom fft(CompPolynom p) {
+        size_t n = p.size();
+        if ((n & (n - 1)) == 0 && n >= SIX_STEP_MIN_SIZE) {
+            SixStepPlan(n).fft(p);
+        } else if ((n & (n - 1)) == 0) {
+            Plan(n).fft(p);
+        } else {
+            MixedPlan(n).fft(p);
+        }
+        return p;
+    }
+
+    CompPolynom fftBack(CompPolynom p) {
+        size_t n = p.size();
+        if ((n & (n - 1)) == 0 && n >= SIX_STEP_MIN_SIZE) {
+            SixStepPlan(n).fftBack(p);
+        } else if ((n & (n - 1)) == 0) {
+            Plan(n).fftBack(p);
+        } else {
+            MixedPlan(n).fftBack(p);
+        }
+        return p;
     } 
 
-    Polynom mult(Polynom a, Polynom b) {
-        size_t n;
-        for (n = 1; n < a.size() || n < b.size(); n *= 2) {}
-        n *= 2;
+    template<typename FftPlan>
+    Polynom mult(Polynom a, Polynom b, FftPlan &plan) {
+        size_t n = plan.size();
         a.resize(n, 0);
         b.resize(n, 0);
-        CompPolynom c = fft(toCompPolynom(a, b));
+        CompPolynom c = toCompPolynom(a, b);
+        plan.fft(c);
         std::pair<CompPolynom, CompPolynom> d = toCompPolynoms(c);
-        CompPolynom ans(n);
         for (size_t i = 0; i < n; ++i) {
-            ans[i] = d.first[i] * d.second[i];
+            c[i] = d.first[i] * d.second[i];
+        }
+        plan.fftBack(c);
+        return toPolynom(c);
+    } 
+
+    template<typename Function>
+    void withPlan(size_t n, Function f) {
+        if ((n & (n - 1)) == 0 && n >= SIX_STEP_MIN_SIZE) {
+            SixStepPlan plan(n);
+            f(plan);
+        } else if ((n & (n - 1)) == 0) {
+            Plan plan(n);
+            f(plan);
+        } else {
+            MixedPlan plan(n);
+            f(plan);
+        }
+    }
+
+    Polynom mult(Polynom a, Polynom b) {
+        if (a.empty() || b.empty()) {
+            return Polynom();
         }
-        return toPolynom(fftBack(ans));
+        Polynom ans;
+        withPlan(goodSize(a.size() + b.size() - 1), [&](auto &plan) {
+            ans = mult(std::move(a), std::move(b), plan);
+        });
+        return ans;
     } 
+
+    struct BatchResult {
+        Polynom values;
+        std::vector<size_t> offsets;
+    };
+
+    BatchResult multBatch(const std::vector<std::pair<Polynom, Polynom> > &pairs, ThreadPool *pool = nullptr) {
+        BatchResult result;
+        result.offsets.assign(pairs.size() + 1, 0);
+        std::map<size_t, std::vector<size_t> > groups;
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            const Polynom &a = pairs[i].first;
+            const Polynom &b = pairs[i].second;
+            size_t size = (a.empty() || b.empty()) ? 0 : a.size() + b.size() - 1;
+            result.offsets[i + 1] = result.offsets[i] + size;
+            if (size > 0) {
+                size_t n;
+                for (n = 1; n < size; n *= 2) {}
+                groups[n].push_back(i);
+            }
+        }
+        result.values.assign(result.offsets.back(), 0);
+        for (const std::pair<const size_t, std::vector<size_t> > &group : groups) {
+            size_t n = group.first;
+            const std::vector<size_t> &indices = group.second;
+            Plan plan(n);
+            auto work = [&](size_t begin, size_t end) {
+                CompPolynom c(n);
+                for (size_t t = begin; t < end; ++t) {
+                    size_t index = indices[t];
+                    const Polynom &a = pairs[index].first;
+                    const Polynom &b = pairs[index].second;
+                    std::fill(c.begin(), c.end(), comp(0));
+                    for (size_t i = 0; i < a.size(); ++i) {
+                        c[i] = static_cast<double>(a[i]);
+                    }
+                    for (size_t i = 0; i < b.size(); ++i) {
+                        c[i] += cI * static_cast<double>(b[i]);
+                    }
+                    plan.fft(c);
+                    for (size_t k = 0; 2 * k <= n; ++k) {
+                        size_t j = (n - k) % n;
+                        comp x = c[k];
+                        comp y = c[j];
+                        c[k] = (x * x - getOpposite(y) * getOpposite(y)) / (4.0 * cI);
+                        c[j] = (y * y - getOpposite(x) * getOpposite(x)) / (4.0 * cI);
+                    }
+                    plan.fftBack(c);
+                    int *out = result.values.data() + result.offsets[index];
+                    for (size_t i = 0; i < a.size() + b.size() - 1; ++i) {
+                        out[i] = static_cast<int>(std::floor(c[i].real() + 0.5));
+                    }
+                }
+            };
+            if (pool != nullptr) {
+                pool->parallelFor(indices.size(), work);
+            } else {
+                work(0, indices.size());
+            }
+        }
+        return result;
+    }
+
+    template<typename T>
+    class BasicRealPlan {
+    private:
+        using Comp = std::complex<T>;
+
+        size_t n = 2;
+        BasicPlan<T> half;
+        std::vector<Comp> roots;
+    public:
+        explicit BasicRealPlan(size_t size) : n(size), half(size / 2) {
+            std::vector<Comp> table = rootTable<T>(n);
+            roots.assign(table.begin() + n / 2, table.begin() + n);
+        }
+
+        size_t size() const {
+            return n;
+        }
+
+        size_t spectrumSize() const {
+            return n / 2 + 1;
+        }
+
+        void fft(const T *x, Comp *out) const {
+            size_t m = n / 2;
+            for (size_t i = 0; i < m; ++i) {
+                out[i] = Comp(x[2 * i], x[2 * i + 1]);
+            }
+            half.fft(out);
+            Comp z = out[0];
+            out[0] = z.real() + z.imag();
+            out[m] = z.real() - z.imag();
+            for (size_t k = 1; 2 * k <= m; ++k) {
+                size_t j = m - k;
+                Comp a = out[k];
+                Comp b = out[j];
+                out[k] = (a + std::conj(b)) / static_cast<T>(2) + roots[k] * (a - std::conj(b)) / Comp(0, 2);
+                out[j] = (b + std::conj(a)) / static_cast<T>(2) + roots[j] * (b - std::conj(a)) / Comp(0, 2);
+            }
+        }
+
+        void fftBack(Comp *spectrum, T *x) const {
+            size_t m = n / 2;
+            Comp a = spectrum[0];
+            Comp b = spectrum[m];
+            spectrum[0] = (a + std::conj(b)) / static_cast<T>(2) + Comp(0, 1) * (a - std::conj(b)) / static_cast<T>(2);
+            for (size_t k = 1; 2 * k <= m; ++k) {
+                size_t j = m - k;
+                a = spectrum[k];
+                b = spectrum[j];
+                spectrum[k] = (a + std::conj(b)) / static_cast<T>(2) + Comp(0, 1) * (a - std::conj(b)) * std::conj(roots[k]) / static_cast<T>(2);
+                spectrum[j] = (b + std::conj(a)) / static_cast<T>(2) + Comp(0, 1) * (b - std::conj(a)) * std::conj(roots[j]) / static_cast<T>(2);
+            }
+            half.fftBack(spectrum);
+            for (size_t i = 0; i < m; ++i) {
+                x[2 * i] = spectrum[i].real();
+                x[2 * i + 1] = spectrum[i].imag();
+            }
+        }
+
+        std::vector<Comp> fft(const std::vector<T> &x) const {
+            std::vector<Comp> out(spectrumSize());
+            fft(x.data(), out.data());
+            return out;
+        }
+
+        std::vector<T> fftBack(std::vector<Comp> spectrum) const {
+            std::vector<T> x(n);
+            fftBack(spectrum.data(), x.data());
+            return x;
+        }
+    };
+
+    using RealPlan = BasicRealPlan<double>;
+
+    Polynom square(const Polynom &a) {
+        if (a.empty()) {
+            return Polynom();
+        }
+        size_t n;
+        for (n = 2; n < 2 * a.size() - 1; n *= 2) {}
+        RealPlan plan(n);
+        std::vector<double> x(n, 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            x[i] = a[i];
+        }
+        CompPolynom spectrum(plan.spectrumSize());
+        plan.fft(x.data(), spectrum.data());
+        for (size_t i = 0; i < spectrum.size(); ++i) {
+            spectrum[i] *= spectrum[i];
+        }
+        plan.fftBack(spectrum.data(), x.data());
+        Polynom ans(2 * a.size() - 1);
+        for (size_t i = 0; i < ans.size(); ++i) {
+            ans[i] = static_cast<int>(std::floor(x[i] + 0.5));
+        }
+        return ans;
+    }
+
+    class StreamConvolver {
+    private:
+        size_t m = 1;
+        size_t step = 1;
+        size_t filled = 0;
+        RealPlan plan;
+        CompPolynom kernelSpectrum;
+        CompPolynom spectrum;
+        std::vector<double> window;
+        std::vector<double> result;
+
+        static size_t blockSizeFor(size_t kernelSize, size_t blockSize) {
+            size_t n;
+            for (n = 2; n < std::max(blockSize, 4 * kernelSize); n *= 2) {}
+            return n;
+        }
+
+        template<typename Output>
+        void processBlock(Output &out, size_t count) {
+            plan.fft(window.data(), spectrum.data());
+            for (size_t i = 0; i < spectrum.size(); ++i) {
+                spectrum[i] *= kernelSpectrum[i];
+            }
+            plan.fftBack(spectrum.data(), result.data());
+            out(result.data() + (m - 1), count);
+            std::copy(window.begin() + step, window.end(), window.begin());
+            filled = 0;
+        }
+    public:
+        explicit StreamConvolver(const std::vector<double> &kernel, size_t blockSize = 0) 
+                : m(std::max(kernel.size(), size_t(1))), 
+                plan(blockSizeFor(m, blockSize)), 
+                kernelSpectrum(plan.spectrumSize()), spectrum(plan.spectrumSize()), 
+                window(plan.size(), 0), result(plan.size()) {
+            step = plan.size() - m + 1;
+            std::vector<double> x(plan.size(), 0);
+            std::copy(kernel.begin(), kernel.end(), x.begin());
+            plan.fft(x.data(), kernelSpectrum.data());
+        }
+
+        size_t blockSize() const {
+            return step;
+        }
+
+        template<typename Output>
+        void push(const double *x, size_t count, Output out) {
+            while (count > 0) {
+                size_t take = std::min(count, step - filled);
+                std::copy(x, x + take, window.begin() + (m - 1) + filled);
+                filled += take;
+                x += take;
+                count -= take;
+                if (filled == step) {
+                    processBlock(out, step);
+                }
+            }
+        }
+
+        template<typename Output>
+        void finish(Output out) {
+            for (size_t left = filled + m - 1; left > 0;) {
+                std::fill(window.begin() + (m - 1) + filled, window.end(), 0.0);
+                size_t count = std::min(left, step);
+                processBlock(out, count);
+                left -= count;
+            }
+            std::fill(window.begin(), window.end(), 0.0);
+        }
+    };
+
+    namespace kernels
+    {
+        template<typename T>
+        using Butterflies = void (*)(T *, T *, T *, T *, const T *, const T *, size_t);
+
+        template<typename T>
+        void butterfliesScalar(T *xr, T *xi, T *yr, T *yi, const T *wr, const T *wi, size_t half) {
+            for (size_t i = 0; i < half; ++i) {
+                T br = yr[i] * wr[i] - yi[i] * wi[i];
+                T bi = yr[i] * wi[i] + yi[i] * wr[i];
+                yr[i] = xr[i] - br;
+                yi[i] = xi[i] - bi;
+                xr[i] += br;
+                xi[i] += bi;
+            }
+        }
+
+#ifdef FFT_X86_KERNELS
+        __attribute__((target("sse2")))
+        void butterfliesSse2(double *xr, double *xi, double *yr, double *yi, 
+                const double *wr, const double *wi, size_t half) {
+            size_t i = 0;
+            for (; i + 2 <= half; i += 2) {
+                __m128d ar = _mm_loadu_pd(xr + i);
+                __m128d ai = _mm_loadu_pd(xi + i);
+                __m128d cr = _mm_loadu_pd(yr + i);
+                __m128d ci = _mm_loadu_pd(yi + i);
+                __m128d vr = _mm_loadu_pd(wr + i);
+                __m128d vi = _mm_loadu_pd(wi + i);
+                __m128d br = _mm_sub_pd(_mm_mul_pd(cr, vr), _mm_mul_pd(ci, vi));
+                __m128d bi = _mm_add_pd(_mm_mul_pd(cr, vi), _mm_mul_pd(ci, vr));
+                _mm_storeu_pd(xr + i, _mm_add_pd(ar, br));
+                _mm_storeu_pd(xi + i, _mm_add_pd(ai, bi));
+                _mm_storeu_pd(yr + i, _mm_sub_pd(ar, br));
+                _mm_storeu_pd(yi + i, _mm_sub_pd(ai, bi));
+            }
+            butterfliesScalar(xr + i, xi + i, yr + i, yi + i, wr + i, wi + i, half - i);
+        }
+
+        __attribute__((target("avx2,fma")))
+        void butterfliesAvx2(double *xr, double *xi, double *yr, double *yi, 
+                const double *wr, const double *wi, size_t half) {
+            size_t i = 0;
+            for (; i + 4 <= half; i += 4) {
+                __m256d ar = _mm256_loadu_pd(xr + i);
+                __m256d ai = _mm256_loadu_pd(xi + i);
+                __m256d cr = _mm256_loadu_pd(yr + i);
+                __m256d ci = _mm256_loadu_pd(yi + i);
+                __m256d vr = _mm256_loadu_pd(wr + i);
+                __m256d vi = _mm256_loadu_pd(wi + i);
+                __m256d br = _mm256_fmsub_pd(cr, vr, _mm256_mul_pd(ci, vi));
+                __m256d bi = _mm256_fmadd_pd(cr, vi, _mm256_mul_pd(ci, vr));
+                _mm256_storeu_pd(xr + i, _mm256_add_pd(ar, br));
+                _mm256_storeu_pd(xi + i, _mm256_add_pd(ai, bi));
+                _mm256_storeu_pd(yr + i, _mm256_sub_pd(ar, br));
+                _mm256_storeu_pd(yi + i, _mm256_sub_pd(ai, bi));
+            }
+            butterfliesScalar(xr + i, xi + i, yr + i, yi + i, wr + i, wi + i, half - i);
+        }
+        __attribute__((target("sse2")))
+        void butterfliesSse2(float *xr, float *xi, float *yr, float *yi, 
+                const float *wr, const float *wi, size_t half) {
+            size_t i = 0;
+            for (; i + 4 <= half; i += 4) {
+                __m128 ar = _mm_loadu_ps(xr + i);
+                __m128 ai = _mm_loadu_ps(xi + i);
+                __m128 cr = _mm_loadu_ps(yr + i);
+                __m128 ci = _mm_loadu_ps(yi + i);
+                __m128 vr = _mm_loadu_ps(wr + i);
+                __m128 vi = _mm_loadu_ps(wi + i);
+                __m128 br = _mm_sub_ps(_mm_mul_ps(cr, vr), _mm_mul_ps(ci, vi));
+                __m128 bi = _mm_add_ps(_mm_mul_ps(cr, vi), _mm_mul_ps(ci, vr));
+                _mm_storeu_ps(xr + i, _mm_add_ps(ar, br));
+                _mm_storeu_ps(xi + i, _mm_add_ps(ai, bi));
+                _mm_storeu_ps(yr + i, _mm_sub_ps(ar, br));
+                _mm_storeu_ps(yi + i, _mm_sub_ps(ai, bi));
+            }
+            butterfliesScalar(xr + i, xi + i, yr + i, yi + i, wr + i, wi + i, half - i);
+        }
+
+        __attribute__((target("avx2,fma")))
+        void butterfliesAvx2(float *xr, float *xi, float *yr, float *yi, 
+                const float *wr, const float *wi, size_t half) {
+            size_t i = 0;
+            for (; i + 8 <= half; i += 8) {
+                __m256 ar = _mm256_loadu_ps(xr + i);
+                __m256 ai = _mm256_loadu_ps(xi + i);
+                __m256 cr = _mm256_loadu_ps(yr + i);
+                __m256 ci = _mm256_loadu_ps(yi + i);
+                __m256 vr = _mm256_loadu_ps(wr + i);
+                __m256 vi = _mm256_loadu_ps(wi + i);
+                __m256 br = _mm256_fmsub_ps(cr, vr, _mm256_mul_ps(ci, vi));
+                __m256 bi = _mm256_fmadd_ps(cr, vi, _mm256_mul_ps(ci, vr));
+                _mm256_storeu_ps(xr + i, _mm256_add_ps(ar, br));
+                _mm256_storeu_ps(xi + i, _mm256_add_ps(ai, bi));
+                _mm256_storeu_ps(yr + i, _mm256_sub_ps(ar, br));
+                _mm256_storeu_ps(yi + i, _mm256_sub_ps(ai, bi));
+            }
+            butterfliesScalar(xr + i, xi + i, yr + i, yi + i, wr + i, wi + i, half - i);
+        }
+#endif
+
+        template<typename T>
+        Butterflies<T> selectButterflies() {
+#ifdef FFT_X86_KERNELS
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                return static_cast<Butterflies<T> >(butterfliesAvx2);
+            }
+            if (__builtin_cpu_supports("sse2")) {
+                return static_cast<Butterflies<T> >(butterfliesSse2);
+            }
+#endif
+            return butterfliesScalar<T>;
+        }
+
+        template<typename T>
+        Butterflies<T> butterflies() {
+            static const Butterflies<T> f = selectButterflies<T>();
+            return f;
+        }
+    }
+
+    template<typename T>
+    class BasicSplitPlan {
+    private:
+        size_t n = 1;
+        std::vector<size_t> rev;
+        std::vector<T> rootsRe;
+        std::vector<T> rootsIm;
+        kernels::Butterflies<T> butterflies;
+
+        void transform(T *re, T *im) const {
+            for (size_t i = 0; i < n; ++i) {
+                if (i < rev[i]) {
+                    std::swap(re[i], re[rev[i]]);
+                    std::swap(im[i], im[rev[i]]);
+                }
+            }
+            for (size_t half = 1; half < n; half *= 2) {
+                for (size_t j = 0; j < n; j += 2 * half) {
+                    butterflies(re + j, im + j, re + j + half, im + j + half, 
+                        rootsRe.data() + half, rootsIm.data() + half, half);
+                }
+            }
+        }
+    public:
+        explicit BasicSplitPlan(size_t size, kernels::Butterflies<T> f = kernels::butterflies<T>()) 
+                : n(size), rev(size, 0), rootsRe(std::max(size, size_t(1)), 1), 
+                rootsIm(std::max(size, size_t(1)), 0), butterflies(f) {
+            size_t num = 0;
+            for (size_t i = n; i > 1; i /= 2, ++num) {}
+            for (size_t i = 1; i < n; ++i) {
+                rev[i] = (rev[i / 2] / 2) | ((i & 1) << (num - 1));
+            }
+            std::vector<std::complex<T> > roots = rootTable<T>(n);
+            for (size_t i = 0; i < roots.size(); ++i) {
+                rootsRe[i] = roots[i].real();
+                rootsIm[i] = roots[i].imag();
+            }
+        }
+
+        size_t size() const {
+            return n;
+        }
+
+        void fft(T *re, T *im) const {
+            transform(re, im);
+        }
+
+        void fftBack(T *re, T *im) const {
+            transform(im, re);
+            for (size_t i = 0; i < n; ++i) {
+                re[i] /= static_cast<T>(n);
+                im[i] /= static_cast<T>(n);
+            }
+        }
+    };
+
+    using SplitPlan = BasicSplitPlan<double>;
+
+    Polynom multSplit(const Polynom &a, const Polynom &b, const SplitPlan &plan) {
+        size_t n = plan.size();
+        std::vector<double> re(n, 0);
+        std::vector<double> im(n, 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            re[i] = a[i];
+        }
+        for (size_t i = 0; i < b.size(); ++i) {
+            im[i] = b[i];
+        }
+        plan.fft(re.data(), im.data());
+        std::vector<double> pr(n);
+        std::vector<double> pi(n);
+        for (size_t i = 0; i < n; ++i) {
+            size_t j = (n - i) % n;
+            comp z = comp(re[i], im[i]);
+            comp zj = comp(re[j], -im[j]);
+            comp p = (z * z - zj * zj) / (4.0 * cI);
+            pr[i] = p.real();
+            pi[i] = p.imag();
+        }
+        plan.fftBack(pr.data(), pi.data());
+        Polynom ans(n);
+        for (size_t i = 0; i < n; ++i) {
+            ans[i] = static_cast<int>(std::floor(pr[i] + 0.5));
+        }
+        return ans;
+    }
+
+    Polynom multSplit(const Polynom &a, const Polynom &b) {
+        size_t n;
+        for (n = 1; n < a.size() + b.size(); n *= 2) {}
+        return multSplit(a, b, SplitPlan(n));
+    }
+
+    template<unsigned N, unsigned G = 3>
+    class NttPlan {
+    private:
+        using Mod = Residue<N>;
+
+        size_t n = 1;
+        std::vector<size_t> rev;
+        std::vector<Mod> roots;
+        std::vector<Mod> backRoots;
+        Mod nInverse = 1;
+
+        void transform(Mod *p, const std::vector<Mod> &w) const {
+            for (size_t i = 0; i < n; ++i) {
+                if (i < rev[i]) {
+                    std::swap(p[i], p[rev[i]]);
+                }
+            }
+            for (size_t half = 1; half < n; half *= 2) {
+                for (size_t j = 0; j < n; j += 2 * half) {
+                    Mod *x = p + j;
+                    Mod *y = p + j + half;
+                    for (size_t i = 0; i < half; ++i) {
+                        Mod ac = x[i];
+                        Mod bc = w[half + i] * y[i];
+                        x[i] = ac + bc;
+                        y[i] = ac - bc;
+                    }
+                }
+            }
+        }
+    public:
+        explicit NttPlan(size_t size) : n(size), rev(size, 0), 
+                roots(std::max(size, size_t(1)), 1), backRoots(roots) {
+            if (n > maxSize()) {
+                throw std::length_error("NttPlan: size exceeds the modulus' largest power-of-two root");
+            }
+            size_t num = 0;
+            for (size_t i = n; i > 1; i /= 2, ++num) {}
+            for (size_t i = 1; i < n; ++i) {
+                rev[i] = (rev[i / 2] / 2) | ((i & 1) << (num - 1));
+            }
+            for (size_t half = 1; half < n; half *= 2) {
+                Mod w = Mod(G).pow(static_cast<unsigned>((N - 1) / (2 * half)));
+                Mod wBack = w.pow(N - 2);
+                for (size_t i = 1; i < half; ++i) {
+                    roots[half + i] = roots[half + i - 1] * w;
+                    backRoots[half + i] = backRoots[half + i - 1] * wBack;
+                }
+            }
+            nInverse = Mod(static_cast<int>(n % N)).pow(N - 2);
+        }
+
+        static size_t maxSize() {
+            return (N - 1) & (0 - (N - 1));
+        }
+
+        size_t size() const {
+            return n;
+        }
+
+        void ntt(Mod *p) const {
+            transform(p, roots);
+        }
+
+        void nttBack(Mod *p) const {
+            transform(p, backRoots);
+            for (size_t i = 0; i < n; ++i) {
+                p[i] *= nInverse;
+            }
+        }
+
+        void ntt(std::vector<Mod> &p) const {
+            ntt(p.data());
+        }
+
+        void nttBack(std::vector<Mod> &p) const {
+            nttBack(p.data());
+        }
+    };
+
+    template<unsigned N, typename T>
+    Residue<N> toResidue(T x) {
+        return static_cast<int>(static_cast<int64_t>(x) % static_cast<int64_t>(N));
+    }
+
+    template<unsigned N>
+    Residue<N> toResidue(Residue<N> x) {
+        return x;
+    }
+
+    template<unsigned N, typename Poly>
+    std::vector<Residue<N> > toResidues(const Poly &a, size_t begin, size_t end, size_t n) {
+        std::vector<Residue<N> > x(n, 0);
+        for (size_t i = begin; i < end; ++i) {
+            x[i - begin] = toResidue<N>(a[i]);
+        }
+        return x;
+    }
+
+    template<unsigned N, unsigned G, typename Poly>
+    std::vector<Residue<N> > convolutionNtt(const Poly &a, const Poly &b) {
+        using Mod = Residue<N>;
+        size_t size = a.size() + b.size() - 1;
+        size_t n;
+        for (n = 1; n < size && n < NttPlan<N, G>::maxSize(); n *= 2) {}
+        NttPlan<N, G> plan(n);
+        if (size <= n) {
+            std::vector<Mod> x = toResidues<N>(a, 0, a.size(), n);
+            std::vector<Mod> y = toResidues<N>(b, 0, b.size(), n);
+            plan.ntt(x);
+            plan.ntt(y);
+            for (size_t i = 0; i < n; ++i) {
+                x[i] *= y[i];
+            }
+            plan.nttBack(x);
+            x.resize(size);
+            return x;
+        }
+        size_t half = n / 2;
+        auto spectra = [&](const Poly &p) {
+            std::vector<std::vector<Mod> > chunks;
+            for (size_t begin = 0; begin < p.size(); begin += half) {
+                chunks.push_back(toResidues<N>(p, begin, std::min(begin + half, p.size()), n));
+                plan.ntt(chunks.back());
+            }
+            return chunks;
+        };
+        std::vector<std::vector<Mod> > x = spectra(a);
+        std::vector<std::vector<Mod> > y = spectra(b);
+        std::vector<Mod> ans(size, 0);
+        std::vector<Mod> sum(n);
+        for (size_t s = 0; s + 1 < x.size() + y.size(); ++s) {
+            std::fill(sum.begin(), sum.end(), Mod(0));
+            size_t first = s < y.size() ? 0 : s - y.size() + 1;
+            for (size_t i = first; i <= s && i < x.size(); ++i) {
+                for (size_t k = 0; k < n; ++k) {
+                    sum[k] += x[i][k] * y[s - i][k];
+                }
+            }
+            plan.nttBack(sum);
+            for (size_t k = 0; k < n && s * half + k < size; ++k) {
+                ans[s * half + k] += sum[k];
+            }
+        }
+        return ans;
+    }
+
+    template<unsigned N, unsigned G = 3>
+    Polynom multNtt(const Polynom &a, const Polynom &b) {
+        if (a.empty() || b.empty()) {
+            return Polynom();
+        }
+        std::vector<Residue<N> > x = convolutionNtt<N, G>(a, b);
+        Polynom ans(x.size());
+        for (size_t i = 0; i < ans.size(); ++i) {
+            ans[i] = static_cast<int>(x[i]);
+        }
+        return ans;
+    }
+
+    LongPolynom multExact(const LongPolynom &a, const LongPolynom &b) {
+        const unsigned M1 = 998244353;
+        const unsigned M2 = 167772161;
+        const unsigned M3 = 469762049;
+        if (a.empty() || b.empty()) {
+            return LongPolynom();
+        }
+        std::vector<Residue<M1> > x1 = convolutionNtt<M1, 3>(a, b);
+        std::vector<Residue<M2> > x2 = convolutionNtt<M2, 3>(a, b);
+        std::vector<Residue<M3> > x3 = convolutionNtt<M3, 3>(a, b);
+        const Residue<M2> inv1 = Residue<M2>(static_cast<int>(M1 % M2)).pow(M2 - 2);
+        const Residue<M3> inv12 = (Residue<M3>(static_cast<int>(M1 % M3)) 
+            * Residue<M3>(static_cast<int>(M2 % M3))).pow(M3 - 2);
+        const __int128 m12 = static_cast<__int128>(M1) * M2;
+        const __int128 m123 = m12 * M3;
+        LongPolynom ans(x1.size());
+        for (size_t i = 0; i < ans.size(); ++i) {
+            int r1 = static_cast<int>(x1[i]);
+            int k2 = static_cast<int>((x2[i] - Residue<M2>(r1 % static_cast<int>(M2))) * inv1);
+            __int128 v = r1 + static_cast<__int128>(M1) * k2;
+            int k3 = static_cast<int>((x3[i] - Residue<M3>(static_cast<int>(v % M3))) * inv12);
+            v += m12 * k3;
+            if (v > m123 / 2) {
+                v -= m123;
+            }
+            ans[i] = static_cast<int64_t>(v);
+        }
+        return ans;
+    }
+
+    const double FFT_SAFE_BITS = 50;
+
+    int coefficientBits(const LongPolynom &p) {
+        int64_t x = 0;
+        for (size_t i = 0; i < p.size(); ++i) {
+            x = std::max(x, p[i] < 0 ? -p[i] : p[i]);
+        }
+        int bits = 0;
+        for (; x > 0; x /= 2, ++bits) {}
+        return bits;
+    }
+
+    template<typename FftPlan>
+    LongPolynom multLong(const LongPolynom &a, const LongPolynom &b, FftPlan &plan) {
+        size_t n = plan.size();
+        CompPolynom c(n, 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            c[i] = static_cast<double>(a[i]);
+        }
+        for (size_t i = 0; i < b.size(); ++i) {
+            c[i] += cI * static_cast<double>(b[i]);
+        }
+        plan.fft(c);
+        std::pair<CompPolynom, CompPolynom> d = toCompPolynoms(c);
+        for (size_t i = 0; i < n; ++i) {
+            c[i] = d.first[i] * d.second[i];
+        }
+        plan.fftBack(c);
+        LongPolynom ans(a.size() + b.size() - 1);
+        for (size_t i = 0; i < ans.size(); ++i) {
+            ans[i] = std::llround(c[i].real());
+        }
+        return ans;
+    }
+
+    template<typename FftPlan>
+    LongPolynom multSplitted(const LongPolynom &a, const LongPolynom &b, int shift, FftPlan &plan) {
+        size_t n = plan.size();
+        const int64_t mask = (int64_t(1) << shift) - 1;
+        CompPolynom p(n, 0);
+        CompPolynom q(n, 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            p[i] = comp(static_cast<double>(a[i] & mask), static_cast<double>(a[i] >> shift));
+        }
+        for (size_t i = 0; i < b.size(); ++i) {
+            q[i] = comp(static_cast<double>(b[i] & mask), static_cast<double>(b[i] >> shift));
+        }
+        plan.fft(p);
+        plan.fft(q);
+        std::pair<CompPolynom, CompPolynom> x = toCompPolynoms(p);
+        std::pair<CompPolynom, CompPolynom> y = toCompPolynoms(q);
+        for (size_t i = 0; i < n; ++i) {
+            p[i] = x.first[i] * y.first[i] + cI * (x.second[i] * y.second[i]);
+            q[i] = x.first[i] * y.second[i] + x.second[i] * y.first[i];
+        }
+        plan.fftBack(p);
+        plan.fftBack(q);
+        LongPolynom ans(a.size() + b.size() - 1);
+        for (size_t i = 0; i < ans.size(); ++i) {
+            int64_t low = std::llround(p[i].real());
+            int64_t middle = std::llround(q[i].real());
+            int64_t high = std::llround(p[i].imag());
+            ans[i] = low + middle * (int64_t(1) << shift) + high * (int64_t(1) << (2 * shift));
+        }
+        return ans;
+    }
+
+    LongPolynom multSafe(const LongPolynom &a, const LongPolynom &b) {
+        if (a.empty() || b.empty()) {
+            return LongPolynom();
+        }
+        size_t n = goodSize(a.size() + b.size() - 1);
+        double lengthBits = std::log2(static_cast<double>(std::min(a.size(), b.size()))) 
+            + std::log2(static_cast<double>(n)) / 2;
+        int bitsA = coefficientBits(a);
+        int bitsB = coefficientBits(b);
+        LongPolynom ans;
+        if (bitsA + bitsB + lengthBits <= FFT_SAFE_BITS) {
+            withPlan(n, [&](auto &plan) {
+                ans = multLong(a, b, plan);
+            });
+            return ans;
+        }
+        int shift = (std::max(bitsA, bitsB) + 1) / 2;
+        if (2 * (shift + 1) + lengthBits <= FFT_SAFE_BITS) {
+            withPlan(n, [&](auto &plan) {
+                ans = multSplitted(a, b, shift, plan);
+            });
+            return ans;
+        }
+        return multExact(a, b);
+    }
+
+    template<unsigned N>
+    using ModPolynom = std::vector<Residue<N> >;
+
+    template<unsigned N>
+    void trim(ModPolynom<N> &a) {
+        while (!a.empty() && a.back() == 0) {
+            a.pop_back();
+        }
+    }
+
+    template<unsigned N, unsigned G = 3>
+    ModPolynom<N> multMod(const ModPolynom<N> &a, const ModPolynom<N> &b) {
+        const size_t NAIVE_MULT_SIZE = 32;
+        if (a.empty() || b.empty()) {
+            return ModPolynom<N>();
+        }
+        if (std::min(a.size(), b.size()) <= NAIVE_MULT_SIZE) {
+            ModPolynom<N> c(a.size() + b.size() - 1, 0);
+            for (size_t i = 0; i < a.size(); ++i) {
+                for (size_t j = 0; j < b.size(); ++j) {
+                    c[i + j] += a[i] * b[j];
+                }
+            }
+            return c;
+        }
+        return convolutionNtt<N, G>(a, b);
+    }
+
+    template<unsigned N, unsigned G = 3>
+    ModPolynom<N> inverseSeries(const ModPolynom<N> &a, size_t k) {
+        if (a.empty() || a[0] == 0) {
+            return ModPolynom<N>();
+        }
+        ModPolynom<N> b(1, a[0].pow(N - 2));
+        for (size_t m = 1; m < k; m *= 2) {
+            ModPolynom<N> cut(a.begin(), a.begin() + std::min(a.size(), 2 * m));
+            ModPolynom<N> t = multMod<N, G>(cut, b);
+            t.resize(2 * m, 0);
+            for (size_t i = 0; i < t.size(); ++i) {
+                t[i] = Residue<N>(i == 0 ? 2 : 0) - t[i];
+            }
+            b = multMod<N, G>(b, t);
+            b.resize(2 * m, 0);
+        }
+        b.resize(k, 0);
+        return b;
+    }
+
+    template<unsigned N, unsigned G = 3>
+    std::pair<ModPolynom<N>, ModPolynom<N> > divMod(ModPolynom<N> a, ModPolynom<N> b) {
+        trim(a);
+        trim(b);
+        if (b.empty() || a.size() < b.size()) {
+            return {ModPolynom<N>(), a};
+        }
+        size_t m = a.size() - b.size() + 1;
+        ModPolynom<N> ra(a.rbegin(), a.rbegin() + m);
+        ModPolynom<N> rb(b.rbegin(), b.rend());
+        ModPolynom<N> q = multMod<N, G>(ra, inverseSeries<N, G>(rb, m));
+        q.resize(m, 0);
+        std::reverse(q.begin(), q.end());
+        ModPolynom<N> bq = multMod<N, G>(b, q);
+        ModPolynom<N> r(b.size() - 1, 0);
+        for (size_t i = 0; i < r.size(); ++i) {
+            r[i] = a[i] - bq[i];
+        }
+        trim(q);
+        trim(r);
+        return {q, r};
+    }
+
+    template<unsigned N, unsigned G = 3>
+    class SubproductTree {
+    private:
+        std::vector<Residue<N> > points;
+        std::vector<ModPolynom<N> > tree;
+
+        void build(size_t v, size_t l, size_t r) {
+            if (r - l == 1) {
+                tree[v] = {Residue<N>(0) - points[l], 1};
+                return;
+            }
+            size_t mid = (l + r) / 2;
+            build(2 * v, l, mid);
+            build(2 * v + 1, mid, r);
+            tree[v] = multMod<N, G>(tree[2 * v], tree[2 * v + 1]);
+        }
+
+        void evaluate(const ModPolynom<N> &a, size_t v, size_t l, size_t r, 
+                std::vector<Residue<N> > &values) const {
+            ModPolynom<N> rest = divMod<N, G>(a, tree[v]).second;
+            if (r - l == 1) {
+                values[l] = rest.empty() ? Residue<N>(0) : rest[0];
+                return;
+            }
+            size_t mid = (l + r) / 2;
+            evaluate(rest, 2 * v, l, mid, values);
+            evaluate(rest, 2 * v + 1, mid, r, values);
+        }
+
+        ModPolynom<N> combine(const std::vector<Residue<N> > &weights, size_t v, size_t l, size_t r) const {
+            if (r - l == 1) {
+                return ModPolynom<N>(1, weights[l]);
+            }
+            size_t mid = (l + r) / 2;
+            ModPolynom<N> x = multMod<N, G>(combine(weights, 2 * v, l, mid), tree[2 * v + 1]);
+            ModPolynom<N> y = multMod<N, G>(combine(weights, 2 * v + 1, mid, r), tree[2 * v]);
+            x.resize(std::max(x.size(), y.size()), 0);
+            for (size_t i = 0; i < y.size(); ++i) {
+                x[i] += y[i];
+            }
+            return x;
+        }
+    public:
+        explicit SubproductTree(const std::vector<Residue<N> > &xs) : points(xs), tree(4 * std::max(xs.size(), size_t(1))) {
+            if (!points.empty()) {
+                build(1, 0, points.size());
+            }
+        }
+
+        const ModPolynom<N>& product() const {
+            return tree[1];
+        }
+
+        std::vector<Residue<N> > evaluate(const ModPolynom<N> &a) const {
+            std::vector<Residue<N> > values(points.size(), 0);
+            if (!points.empty()) {
+                evaluate(a, 1, 0, points.size(), values);
+            }
+            return values;
+        }
+
+        ModPolynom<N> interpolate(const std::vector<Residue<N> > &ys) const {
+            if (points.empty()) {
+                return ModPolynom<N>();
+            }
+            const ModPolynom<N> &m = product();
+            ModPolynom<N> derivative(m.size() - 1);
+            for (size_t i = 1; i < m.size(); ++i) {
+                derivative[i - 1] = m[i] * Residue<N>(static_cast<int>(i));
+            }
+            std::vector<Residue<N> > weights = evaluate(derivative);
+            for (size_t i = 0; i < weights.size(); ++i) {
+                weights[i] = ys[i] * weights[i].pow(N - 2);
+            }
+            ModPolynom<N> ans = combine(weights, 1, 0, points.size());
+            trim(ans);
+            return ans;
+        }
+    };
+
+    template<unsigned N, unsigned G = 3>
+    std::vector<Residue<N> > evaluate(const ModPolynom<N> &a, const std::vector<Residue<N> > &xs) {
+        return SubproductTree<N, G>(xs).evaluate(a);
+    }
+
+    template<unsigned N, unsigned G = 3>
+    ModPolynom<N> interpolate(const std::vector<Residue<N> > &xs, const std::vector<Residue<N> > &ys) {
+        return SubproductTree<N, G>(xs).interpolate(ys);
+    }
 }
\ No newline at end of file
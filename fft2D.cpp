@@ -2,209 +2,174 @@
 #include <vector>
 #include <complex>
 
+#include "fastfft.h"
+
 namespace fft
 {
     template<typename T>
     using vec = std::vector<T>;
 
-    using comp = std::complex<double>;
-    using Polynom = vec<int>;
-    using CompPolynom = vec<comp>;
     using Matrix = vec<vec<int> >;
     using CompMatrix = vec<vec<comp> >;
 
-    const long double PI = acosl(-1);
-    const comp cI = comp(0, 1); 
-
-    comp& opposite(comp &c) {
-        c.imag(-c.imag());
-        return c;
-    }
+    const size_t COLUMN_BLOCK = 8;
 
-    comp getOpposite(comp c) {
-        opposite(c);
-        return c;
+    template<typename T>
+    void rowsFFT(std::complex<T> *a, size_t rows, size_t cols, bool back, ThreadPool &pool) {
+        BasicMixedPlan<T> plan(cols);
+        pool.parallelFor(rows, [&](size_t begin, size_t end) {
+            std::vector<std::complex<T> > buffer(cols);
+            for (size_t i = begin; i < end; ++i) {
+                if (back) {
+                    plan.fftBack(a + i * cols, buffer.data());
+                } else {
+                    plan.fft(a + i * cols, buffer.data());
+                }
+            }
+        });
     }
 
-    CompPolynom toCompPolynom(const Polynom &p) {
-        CompPolynom x(p.size());
-        for (size_t i = 0; i < p.size(); ++i) {
-            x[i] = p[i];
-        }
-        return x;
+    template<typename T>
+    void columnsFFT(std::complex<T> *a, size_t rows, size_t cols, bool back, ThreadPool &pool) {
+        BasicMixedPlan<T> plan(rows);
+        size_t blocks = (cols + COLUMN_BLOCK - 1) / COLUMN_BLOCK;
+        pool.parallelFor(blocks, [&](size_t begin, size_t end) {
+            std::vector<std::complex<T> > block(COLUMN_BLOCK * rows);
+            std::vector<std::complex<T> > buffer(rows);
+            for (size_t b = begin; b < end; ++b) {
+                size_t c0 = b * COLUMN_BLOCK;
+                size_t width = std::min(COLUMN_BLOCK, cols - c0);
+                for (size_t i = 0; i < rows; ++i) {
+                    for (size_t j = 0; j < width; ++j) {
+                        block[j * rows + i] = a[i * cols + c0 + j];
+                    }
+                }
+                for (size_t j = 0; j < width; ++j) {
+                    if (back) {
+                        plan.fftBack(block.data() + j * rows, buffer.data());
+                    } else {
+                        plan.fft(block.data() + j * rows, buffer.data());
+                    }
+                }
+                for (size_t i = 0; i < rows; ++i) {
+                    for (size_t j = 0; j < width; ++j) {
+                        a[i * cols + c0 + j] = block[j * rows + i];
+                    }
+                }
+            }
+        });
     }
 
-    CompPolynom toCompPolynom(const Polynom &p, const Polynom &q) {
-        CompPolynom x(p.size());
-        for (size_t i = 0; i < p.size(); ++i) {
-            x[i] = static_cast<comp>(p[i]) + cI * static_cast<double>(q[i]);
-        } 
-        return x;
+    template<typename T>
+    void matrixFFT(std::vector<std::complex<T> > &a, size_t rows, size_t cols, ThreadPool &pool = defaultPool()) {
+        rowsFFT(a.data(), rows, cols, false, pool);
+        columnsFFT(a.data(), rows, cols, false, pool);
     }
 
-    std::pair<CompPolynom, CompPolynom> toCompPolynoms(const CompPolynom &p) {
-        size_t n = p.size();
-        CompPolynom x(n, 0);
-        CompPolynom y(n, 0);
-        for (size_t i = 0; i < n; ++i) {
-            x[i] = (p[i] + getOpposite(p[(n - i) % n])) / 2.0;
-            y[i] = (p[i] - getOpposite(p[(n - i) % n])) / (2.0 * cI);
-        }
-        return {x, y};
+    template<typename T>
+    void matrixFFTBack(std::vector<std::complex<T> > &a, size_t rows, size_t cols, ThreadPool &pool = defaultPool()) {
+        columnsFFT(a.data(), rows, cols, true, pool);
+        rowsFFT(a.data(), rows, cols, true, pool);
     }
 
-    Polynom toPolynom(const CompPolynom &p) {
-        Polynom x(p.size());
-        for (size_t i = 0; i < p.size(); ++i) {
-            x[i] = static_cast<int>(p[i].real() + 0.5);
+    CompPolynom toFlat(const CompMatrix &a) {
+        CompPolynom x;
+        x.reserve(a.size() * a[0].size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            x.insert(x.end(), a[i].begin(), a[i].end());
         }
         return x;
     }
 
-    comp getKCompRoot(size_t n, int k) {
-        double angle = (2 * PI * k) / n;
-        return comp(std::cos(angle), std::sin(angle));
-    }
-
-    size_t backBForm(size_t n, size_t num) {
-        size_t ans = 0;
-        for (size_t i = 0; i < num; ++i) {
-            if (n & (1 << i)) {
-                ans += (1 << (num - i - 1));
-            }
-        }
-        return ans;
-    }
-
-    CompPolynom fft(CompPolynom p, comp w) {
-        if (p.size() == 1) {
-            return p;
-        }
-        size_t num = 0;
-        for (size_t i = p.size(); i > 1; i /= 2, ++num) {}
-        std::vector<comp> a(num, 0);
-        a[0] = w;
-        for (size_t i = 1; i < a.size(); ++i) {
-            a[i] = a[i - 1] * a[i - 1];
-        }
-        for (size_t i = 0; i < p.size(); ++i) {
-            size_t j = backBForm(i, num);
-            if (i < j) {
-                swap(p[i], p[j]);
-            }
-        }
-        size_t t = 1;
-        for (size_t part = 2; part <= p.size(); part *= 2, ++t) {
-            size_t partHalf = part / 2;
-            for (size_t j = 0; j < p.size(); j += part) {
-                comp c = 1;
-                size_t i = j;
-                size_t k = j + partHalf;
-                for (; i < j + partHalf; ++i, ++k, c *= a[num - t]) {
-                    comp ac = p[i];
-                    comp bc = c * p[k];
-                    p[i] = ac + bc;
-                    p[k] = ac - bc;
-                }
-            }
+    CompMatrix fromFlat(const CompPolynom &x, size_t rows, size_t cols) {
+        CompMatrix a(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            a[i].assign(x.begin() + i * cols, x.begin() + (i + 1) * cols);
         }
-        return p;
+        return a;
     }
 
-    CompPolynom fft(const CompPolynom &p) {
-        return fft(p, getKCompRoot(p.size(), 1));
+    CompMatrix matrixFFT(CompMatrix &a) {
+        CompPolynom x = toFlat(a);
+        matrixFFT(x, a.size(), a[0].size());
+        a = fromFlat(x, a.size(), a[0].size());
+        return a;
     }
 
-    CompPolynom fftBack(const CompPolynom &p) {
-        CompPolynom x = fft(p, getKCompRoot(p.size(), -1));
-        for (size_t i = 0; i < x.size(); ++i) {
-            x[i] /= p.size();
-        }
-        return x;
-    } 
-
-    size_t normSize(size_t s) {
-        size_t n;
-        for (n = 1; n < s; n *= 2) {}
-        return n;
+    CompMatrix matrixFFTBack(CompMatrix &a) {
+        CompPolynom x = toFlat(a);
+        matrixFFTBack(x, a.size(), a[0].size());
+        a = fromFlat(x, a.size(), a[0].size());
+        return a;
     }
 
-    Polynom mult(Polynom a, Polynom b) {
-        size_t n = normSize(std::max(a.size(), b.size()));
-        n *= 2;
-        a.resize(n, 0);
-        b.resize(n, 0);
-        CompPolynom c = fft(toCompPolynom(a, b));
-        std::pair<CompPolynom, CompPolynom> d = toCompPolynoms(c);
-        CompPolynom ans(n);
-        for (size_t i = 0; i < n; ++i) {
-            ans[i] = d.first[i] * d.second[i];
-        }
-        return toPolynom(fftBack(ans));
-    } 
-
-    template<typename Field>
-    vec<vec<Field> > transposeMatrix(const vec<vec<Field> > &a) {
-        vec<vec<Field> > b(a[0].size(), vec<Field>(a.size()));
-        for (size_t i = 0; i < a.size(); ++i) {
-            for (size_t j = 0; j < a[0].size(); ++j) {
-                b[j][i] = a[i][j];
+    CompPolynom halfSpectrumProduct(const CompPolynom &z, size_t rows, size_t cols) {
+        size_t half = cols / 2 + 1;
+        CompPolynom spectrum(rows * half);
+        for (size_t i = 0; i < rows; ++i) {
+            size_t oppositeRow = (rows - i) % rows;
+            for (size_t j = 0; j < half; ++j) {
+                comp x = z[i * cols + j];
+                comp y = getOpposite(z[oppositeRow * cols + (cols - j) % cols]);
+                spectrum[i * half + j] = (x * x - y * y) / (4.0 * cI);
             }
         }
-        return b;
+        return spectrum;
     }
 
-    CompMatrix matrixFFT(CompMatrix &a) {
-        for (size_t i = 0; i < a.size(); ++i) {
-            a[i] = fft(a[i]);
-        }
-        a = transposeMatrix(a);
-        for (size_t i = 0; i < a.size(); ++i) {
-            a[i] = fft(a[i]);
-        }
-        a = transposeMatrix(a);
-        return a;
+    void rowsFromHalfSpectrum(const CompPolynom &spectrum, size_t rows, size_t cols, 
+            Matrix &ans, ThreadPool &pool) {
+        size_t half = cols / 2 + 1;
+        MixedPlan plan(cols);
+        pool.parallelFor((rows + 1) / 2, [&](size_t begin, size_t end) {
+            CompPolynom row(cols);
+            CompPolynom buffer(cols);
+            for (size_t t = begin; t < end; ++t) {
+                const comp *x = spectrum.data() + 2 * t * half;
+                bool paired = 2 * t + 1 < rows;
+                for (size_t j = 0; j < cols; ++j) {
+                    comp u = j < half ? x[j] : getOpposite(x[cols - j]);
+                    comp v = 0;
+                    if (paired) {
+                        v = j < half ? x[half + j] : getOpposite(x[half + cols - j]);
+                    }
+                    row[j] = u + cI * v;
+                }
+                plan.fftBack(row.data(), buffer.data());
+                for (size_t j = 0; j < cols; ++j) {
+                    ans[2 * t][j] = static_cast<int>(std::floor(row[j].real() + 0.5));
+                    if (paired) {
+                        ans[2 * t + 1][j] = static_cast<int>(std::floor(row[j].imag() + 0.5));
+                    }
+                }
+            }
+        });
     }
 
-    CompMatrix matrixFFTBack(CompMatrix &a) {
-        a = transposeMatrix(a);
-        for (size_t i = 0; i < a.size(); ++i) {
-            a[i] = fftBack(a[i]);
-        }
-        a = transposeMatrix(a);
+    Matrix matrixMult(const Matrix &a, const Matrix &b, ThreadPool &pool) {
+        size_t n = goodSize(a.size() + b.size() - 1);
+        size_t k = goodSize(a[0].size() + b[0].size() - 1);
+        CompPolynom z(n * k, 0);
         for (size_t i = 0; i < a.size(); ++i) {
-            a[i] = fftBack(a[i]);
-        }
-        return a;
-    }
-
-    Matrix matrixMult(Matrix a, Matrix b) {
-        size_t n = normSize(std::max(a.size(), b.size()));
-        size_t k = normSize(std::max(a[0].size(), b[0].size()));
-        n *= 2;
-        k *= 2;
-        a.resize(n);
-        b.resize(n);
-        CompMatrix c(n);
-        CompMatrix d(n);
-        for (size_t i = 0; i < n; ++i) {
-            a[i].resize(k, 0);
-            b[i].resize(k, 0);
-            c[i] = toCompPolynom(a[i]);
-            d[i] = toCompPolynom(b[i]);
-        }
-        c = matrixFFT(c);
-        d = matrixFFT(d);
-        for (size_t i = 0; i < n; ++i) {
-            for (size_t j = 0; j < k; ++j) {
-                c[i][j] = c[i][j] * d[i][j];
+            for (size_t j = 0; j < a[i].size(); ++j) {
+                z[i * k + j] = a[i][j];
             }
         }
-        c = matrixFFTBack(c);
-        Matrix ans(n);
-        for (size_t i = 0; i < n; ++i) {
-            ans[i] = toPolynom(c[i]); 
+        for (size_t i = 0; i < b.size(); ++i) {
+            for (size_t j = 0; j < b[i].size(); ++j) {
+                z[i * k + j] += cI * static_cast<double>(b[i][j]);
+            }
         }
+        matrixFFT(z, n, k, pool);
+        CompPolynom spectrum = halfSpectrumProduct(z, n, k);
+        CompPolynom().swap(z);
+        columnsFFT(spectrum.data(), n, k / 2 + 1, true, pool);
+        Matrix ans(n, Polynom(k));
+        rowsFromHalfSpectrum(spectrum, n, k, ans, pool);
         return ans;
     }
-}
+
+    Matrix matrixMult(const Matrix &a, const Matrix &b) {
+        return matrixMult(a, b, defaultPool());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace recursive {
+#include "fft.h"
+}
+
+namespace bigint {
+#include "biginteger.h"
+}
+
+namespace matrix {
+#include "matrix.h"
+}
+
+#include "fft2D.cpp"
+
+using Clock = std::chrono::steady_clock;
+using ExactComp = std::complex<long double>;
+
+const size_t POINTS_PER_MEASURE = 1 << 20;
+const size_t MAX_REFERENCE_SIZE = 1 << 20;
+const int64_t MAX_COEFFICIENT = 1000;
+const int64_t MAX_RESULT = 998244353;
+const size_t MAX_SCHOOLBOOK_SIZE = 1 << 13;
+
+std::mt19937_64 rnd(42);
+
+template<typename Reset, typename Function>
+double measure(size_t n, Reset reset, Function f) {
+    size_t reps = std::max(POINTS_PER_MEASURE / n, size_t(1));
+    reset();
+    f();
+    std::chrono::duration<double, std::nano> time(0);
+    for (size_t i = 0; i < reps; ++i) {
+        reset();
+        Clock::time_point start = Clock::now();
+        f();
+        time += Clock::now() - start;
+    }
+    return time.count() / (static_cast<double>(reps) * n);
+}
+
+template<typename Function>
+double measure(size_t n, Function f) {
+    size_t reps = std::max(POINTS_PER_MEASURE / n, size_t(1));
+    f();
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < reps; ++i) {
+        f();
+    }
+    std::chrono::duration<double, std::nano> time = Clock::now() - start;
+    return time.count() / (static_cast<double>(reps) * n);
+}
+
+void report(const std::string &name, const std::string &operation, size_t n, double ns, double error) {
+    std::cout << name << ',' << operation << ',' << __builtin_ctzll(n) << ',' << n << ',' << ns << ',';
+    if (error >= 0) {
+        std::cout << error;
+    }
+    std::cout << '\n';
+}
+
+template<typename Comp>
+double transformError(const std::vector<Comp> &x, const std::vector<ExactComp> &reference) {
+    if (reference.empty()) {
+        return -1;
+    }
+    long double error = 0;
+    long double scale = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        ExactComp v(x[i].real(), x[i].imag());
+        error = std::max(error, std::abs(v - reference[i]));
+        scale = std::max(scale, std::abs(reference[i]));
+    }
+    return static_cast<double>(error / std::max(scale, 1.0L));
+}
+
+std::vector<ExactComp> exactTransform(std::vector<ExactComp> x) {
+    if (x.size() > MAX_REFERENCE_SIZE) {
+        return std::vector<ExactComp>();
+    }
+    fft::BasicPlan<long double>(x.size()).fft(x);
+    return x;
+}
+
+std::vector<ExactComp> exactMatrixTransform(const fft::CompPolynom &x, size_t side) {
+    if (x.size() > MAX_REFERENCE_SIZE) {
+        return std::vector<ExactComp>();
+    }
+    std::vector<ExactComp> a(x.begin(), x.end());
+    std::vector<ExactComp> column(side);
+    fft::BasicPlan<long double> plan(side);
+    for (size_t i = 0; i < side; ++i) {
+        plan.fft(a.data() + i * side);
+    }
+    for (size_t j = 0; j < side; ++j) {
+        for (size_t i = 0; i < side; ++i) {
+            column[i] = a[i * side + j];
+        }
+        plan.fft(column);
+        for (size_t i = 0; i < side; ++i) {
+            a[i * side + j] = column[i];
+        }
+    }
+    return a;
+}
+
+fft::LongPolynom multSchoolbook(const fft::LongPolynom &a, const fft::LongPolynom &b) {
+    fft::LongPolynom c(a.size() + b.size() - 1, 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < b.size(); ++j) {
+            c[i + j] += a[i] * b[j];
+        }
+    }
+    return c;
+}
+
+template<typename Result>
+double multError(const Result &x, const fft::LongPolynom &exact) {
+    if (exact.empty()) {
+        return -1;
+    }
+    double error = 0;
+    for (size_t i = 0; i < exact.size(); ++i) {
+        double v = i < x.size() ? static_cast<double>(x[i]) : 0;
+        error = std::max(error, std::abs(v - static_cast<double>(exact[i])));
+    }
+    return error;
+}
+
+template<typename Vector, typename Forward, typename Backward>
+void benchInPlace(const std::string &name, size_t n, const Vector &x, const std::vector<ExactComp> &reference, 
+        Forward forward, Backward backward) {
+    Vector y = x;
+    forward(y);
+    double error = transformError(y, reference);
+    Vector spectrum = y;
+    report(name, "forward", n, measure(n, [&] { y = x; }, [&] { forward(y); }), error);
+    report(name, "inverse", n, measure(n, [&] { y = spectrum; }, [&] { backward(y); }), -1);
+}
+
+void benchTransforms(size_t n) {
+    fft::CompPolynom x(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = fft::comp(rnd() % 1000 / 1000.0, rnd() % 1000 / 1000.0);
+    }
+    std::vector<ExactComp> reference = exactTransform(std::vector<ExactComp>(x.begin(), x.end()));
+
+    fft::CompPolynom y = recursive::fft::fft(x);
+    double error = transformError(y, reference);
+    report("recursive", "forward", n, measure(n, [&] { y = recursive::fft::fft(x); }), error);
+    report("recursive", "inverse", n, measure(n, [&] { y = recursive::fft::fftBack(x); }), -1);
+    y = bigint::fft::fft(x);
+    error = transformError(y, reference);
+    report("biginteger", "forward", n, measure(n, [&] { y = bigint::fft::fft(x); }), error);
+    report("biginteger", "inverse", n, measure(n, [&] { y = bigint::fft::fftBack(x); }), -1);
+    y = matrix::fft::fft(x);
+    error = transformError(y, reference);
+    report("matrix", "forward", n, measure(n, [&] { y = matrix::fft::fft(x); }), error);
+    report("matrix", "inverse", n, measure(n, [&] { y = matrix::fft::fftBack(x); }), -1);
+
+    fft::Plan plan(n);
+    benchInPlace("plan", n, x, reference, 
+        [&](fft::CompPolynom &p) { plan.fft(p); }, [&](fft::CompPolynom &p) { plan.fftBack(p); });
+    fft::MixedPlan mixed(n);
+    benchInPlace("mixed", n, x, reference, 
+        [&](fft::CompPolynom &p) { mixed.fft(p); }, [&](fft::CompPolynom &p) { mixed.fftBack(p); });
+    fft::SixStepPlan sixStep(n);
+    benchInPlace("sixstep", n, x, reference, 
+        [&](fft::CompPolynom &p) { sixStep.fft(p); }, [&](fft::CompPolynom &p) { sixStep.fftBack(p); });
+
+    fft::SplitPlan split(n);
+    std::vector<double> re(n);
+    std::vector<double> im(n);
+    for (size_t i = 0; i < n; ++i) {
+        re[i] = x[i].real();
+        im[i] = x[i].imag();
+    }
+    std::vector<double> re0 = re;
+    std::vector<double> im0 = im;
+    split.fft(re.data(), im.data());
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = fft::comp(re[i], im[i]);
+    }
+    error = transformError(y, reference);
+    std::vector<double> reSpectrum = re;
+    std::vector<double> imSpectrum = im;
+    report("split", "forward", n, measure(n, [&] { re = re0; im = im0; }, 
+        [&] { split.fft(re.data(), im.data()); }), error);
+    report("split", "inverse", n, measure(n, [&] { re = reSpectrum; im = imSpectrum; }, 
+        [&] { split.fftBack(re.data(), im.data()); }), -1);
+
+    fft::BasicPlan<float> floatPlan(n);
+    benchInPlace("plan_float", n, std::vector<std::complex<float> >(x.begin(), x.end()), reference, 
+        [&](std::vector<std::complex<float> > &p) { floatPlan.fft(p); }, 
+        [&](std::vector<std::complex<float> > &p) { floatPlan.fftBack(p); });
+
+    if (n >= 2) {
+        fft::RealPlan real(n);
+        std::vector<double> samples(n);
+        for (size_t i = 0; i < n; ++i) {
+            samples[i] = x[i].real();
+        }
+        fft::CompPolynom spectrum(real.spectrumSize());
+        real.fft(samples.data(), spectrum.data());
+        error = transformError(spectrum, exactTransform(std::vector<ExactComp>(samples.begin(), samples.end())));
+        fft::CompPolynom realSpectrum = spectrum;
+        report("real", "forward", n, measure(n, [&] { real.fft(samples.data(), spectrum.data()); }), error);
+        report("real", "inverse", n, measure(n, [&] { spectrum = realSpectrum; }, 
+            [&] { real.fftBack(spectrum.data(), samples.data()); }), -1);
+    }
+
+    size_t log = __builtin_ctzll(n);
+    if (log % 2 == 0) {
+        size_t side = size_t(1) << (log / 2);
+        benchInPlace("matrix2d", n, x, exactMatrixTransform(x, side), 
+            [&](fft::CompPolynom &p) { fft::matrixFFT(p, side, side); }, 
+            [&](fft::CompPolynom &p) { fft::matrixFFTBack(p, side, side); });
+    }
+}
+
+void benchMult(size_t n) {
+    size_t half = std::max(n / 2, size_t(1));
+    int64_t maxCoefficient = std::min(MAX_COEFFICIENT, 
+        static_cast<int64_t>(std::sqrt(static_cast<double>(MAX_RESULT) / half)));
+    fft::Polynom a(half);
+    fft::Polynom b(half);
+    for (size_t i = 0; i < half; ++i) {
+        a[i] = rnd() % maxCoefficient;
+        b[i] = rnd() % maxCoefficient;
+    }
+    fft::LongPolynom la(a.begin(), a.end());
+    fft::LongPolynom lb(b.begin(), b.end());
+    fft::LongPolynom exact;
+    if (2 * half - 1 <= fft::NttPlan<998244353>::maxSize()) {
+        exact = fft::multExact(la, lb);
+    }
+
+    recursive::fft::Polynom recursiveResult;
+    double ns = measure(n, [&] { recursiveResult = recursive::fft::mult(la, lb); });
+    report("recursive", "mult", n, ns, multError(recursiveResult, exact));
+    bigint::fft::Polynom bigintResult;
+    ns = measure(n, [&] { bigintResult = bigint::fft::mult(la, lb); });
+    report("biginteger", "mult", n, ns, multError(bigintResult, exact));
+    matrix::fft::Polynom matrixResult;
+    ns = measure(n, [&] { matrixResult = matrix::fft::mult(la, lb); });
+    report("matrix", "mult", n, ns, multError(matrixResult, exact));
+
+    fft::Polynom result;
+    ns = measure(n, [&] { result = fft::mult(a, b); });
+    report("fastfft", "mult", n, ns, multError(result, exact));
+    ns = measure(n, [&] { result = fft::multSplit(a, b); });
+    report("split", "mult", n, ns, multError(result, exact));
+    ns = measure(n, [&] { result = fft::multNtt<998244353>(a, b); });
+    report("ntt", "mult", n, ns, multError(result, exact));
+
+    fft::LongPolynom longResult;
+    ns = measure(n, [&] { longResult = fft::multSafe(la, lb); });
+    report("safe", "mult", n, ns, multError(longResult, exact));
+    fft::LongPolynom schoolbook;
+    if (half <= MAX_SCHOOLBOOK_SIZE) {
+        schoolbook = multSchoolbook(la, lb);
+    }
+    ns = measure(n, [&] { longResult = fft::multExact(la, lb); });
+    report("exact", "mult", n, ns, multError(longResult, schoolbook));
+}
+
+int main(int argc, char **argv) {
+    size_t minLog = argc > 1 ? std::atoi(argv[1]) : 4;
+    size_t maxLog = argc > 2 ? std::atoi(argv[2]) : 24;
+    std::cout << "implementation,operation,log2n,n,ns_per_point,max_error\n";
+    for (size_t log = minLog; log <= maxLog; ++log) {
+        size_t n = size_t(1) << log;
+        benchTransforms(n);
+        benchMult(n);
+    }
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace fft
+{
+    class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()> > tasks;
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool stopped = false;
+
+        void work() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [this] { return stopped || !tasks.empty(); });
+                    if (tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop();
+                }
+                task();
+            }
+        }
+
+        bool runPending() {
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (tasks.empty()) {
+                    return false;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+            return true;
+        }
+    public:
+        explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+            for (size_t i = 0; i < threads; ++i) {
+                workers.emplace_back([this] { work(); });
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool& operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopped = true;
+            }
+            cv.notify_all();
+            for (std::thread &worker : workers) {
+                worker.join();
+            }
+        }
+
+        size_t size() const {
+            return workers.size();
+        }
+
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push(std::move(task));
+            }
+            cv.notify_one();
+        }
+
+        template<typename Function>
+        void parallelFor(size_t count, Function f) {
+            size_t parts = std::min(count, 4 * workers.size());
+            if (parts <= 1) {
+                if (count > 0) {
+                    f(size_t(0), count);
+                }
+                return;
+            }
+            std::mutex doneMutex;
+            std::condition_variable doneCv;
+            size_t left = parts;
+            for (size_t i = 0; i < parts; ++i) {
+                size_t begin = count * i / parts;
+                size_t end = count * (i + 1) / parts;
+                submit([&, begin, end] {
+                    f(begin, end);
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    if (--left == 0) {
+                        doneCv.notify_one();
+                    }
+                });
+            }
+            std::unique_lock<std::mutex> lock(doneMutex);
+            doneCv.wait(lock, [&] { return left == 0; });
+        }
+
+        void runAll(const std::vector<std::function<void()> > &jobs) {
+            if (jobs.empty()) {
+                return;
+            }
+            std::atomic<size_t> left(jobs.size() - 1);
+            for (size_t i = 1; i < jobs.size(); ++i) {
+                const std::function<void()> &job = jobs[i];
+                submit([&job, &left] {
+                    job();
+                    --left;
+                });
+            }
+            jobs[0]();
+            while (left > 0) {
+                if (!runPending()) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    };
+
+    void runAll(ThreadPool *pool, const std::vector<std::function<void()> > &jobs) {
+        if (pool == nullptr) {
+            for (const std::function<void()> &job : jobs) {
+                job();
+            }
+        } else {
+            pool->runAll(jobs);
+        }
+    }
+}